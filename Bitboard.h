@@ -0,0 +1,107 @@
+#ifndef REVERSI_BITBOARD_H
+#define REVERSI_BITBOARD_H
+
+#include <cstdint>
+
+// Bitboard helpers shared by the engine add-ons.
+// Square index is row * 8 + col, the same layout as board[row][col].
+
+const int BB_SIZE = 8;
+const int BB_SQUARES = 64;
+const int BB_PASS = 64;
+
+const uint64_t BB_NOT_EDGE_COLS = 0x7E7E7E7E7E7E7E7EULL;
+const uint64_t BB_NOT_EDGE_ROWS = 0x00FFFFFFFFFFFF00ULL;
+const uint64_t BB_INNER = 0x007E7E7E7E7E7E00ULL;
+
+inline uint64_t squareBit(int sq) {
+    return 1ULL << sq;
+}
+
+inline int popCount(uint64_t b) {
+    return __builtin_popcountll(b);
+}
+
+inline int firstSquare(uint64_t b) {
+    return __builtin_ctzll(b);
+}
+
+// Moves along one axis in both directions (shift and reverse shift)
+inline uint64_t movesAlong(uint64_t P, uint64_t mask, int shift) {
+    uint64_t f = mask & (P << shift);
+    f |= mask & (f << shift);
+    f |= mask & (f << shift);
+    f |= mask & (f << shift);
+    f |= mask & (f << shift);
+    f |= mask & (f << shift);
+    uint64_t moves = f << shift;
+
+    f = mask & (P >> shift);
+    f |= mask & (f >> shift);
+    f |= mask & (f >> shift);
+    f |= mask & (f >> shift);
+    f |= mask & (f >> shift);
+    f |= mask & (f >> shift);
+    moves |= f >> shift;
+    return moves;
+}
+
+// All legal moves for the side owning P
+inline uint64_t getMoves(uint64_t P, uint64_t O) {
+    uint64_t moves = movesAlong(P, O & BB_NOT_EDGE_COLS, 1)
+                   | movesAlong(P, O & BB_NOT_EDGE_ROWS, 8)
+                   | movesAlong(P, O & BB_INNER, 7)
+                   | movesAlong(P, O & BB_INNER, 9);
+    return moves & ~(P | O);
+}
+
+// Discs flipped when the side owning P plays sq (0 if the move is illegal)
+inline uint64_t getFlips(int sq, uint64_t P, uint64_t O) {
+    static const int directions[8][2] = {{-1,-1},{-1,0},{-1,1},{0,-1},{0,1},{1,-1},{1,0},{1,1}};
+    int row = sq / BB_SIZE;
+    int col = sq % BB_SIZE;
+    uint64_t flips = 0;
+
+    for (int i = 0; i < 8; i++) {
+        int r = row + directions[i][0];
+        int c = col + directions[i][1];
+        uint64_t line = 0;
+        while (r >= 0 && r < BB_SIZE && c >= 0 && c < BB_SIZE) {
+            uint64_t bit = squareBit(r * BB_SIZE + c);
+            if (O & bit) {
+                line |= bit;
+            } else {
+                if (P & bit) flips |= line;
+                break;
+            }
+            r += directions[i][0];
+            c += directions[i][1];
+        }
+    }
+    return flips;
+}
+
+// Plays sq for the side owning P; returns false if the move is illegal
+inline bool playMove(int sq, uint64_t &P, uint64_t &O) {
+    if ((P | O) & squareBit(sq)) return false;
+    uint64_t flips = getFlips(sq, P, O);
+    if (flips == 0) return false;
+    P |= flips | squareBit(sq);
+    O &= ~flips;
+    return true;
+}
+
+// Splits a board[8][8] array into bitboards from player's point of view
+inline void boardToBitboards(const int b[BB_SIZE][BB_SIZE], int player, uint64_t &P, uint64_t &O) {
+    P = 0;
+    O = 0;
+    for (int i = 0; i < BB_SIZE; i++) {
+        for (int j = 0; j < BB_SIZE; j++) {
+            if (b[i][j] == 0) continue;
+            if (b[i][j] == player) P |= squareBit(i * BB_SIZE + j);
+            else O |= squareBit(i * BB_SIZE + j);
+        }
+    }
+}
+
+#endif
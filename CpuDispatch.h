@@ -0,0 +1,328 @@
+#ifndef REVERSI_CPU_DISPATCH_H
+#define REVERSI_CPU_DISPATCH_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include "Bitboard.h"
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+    #define REVERSI_X86_DISPATCH 1
+    #include <immintrin.h>
+#endif
+
+// Runtime-selected engine kernels.
+//
+// The binary is built for the baseline target; the SSE2, AVX2 (+BMI2,
+// POPCNT) and AVX-512 variants are compiled with per-function target
+// attributes and only called after CPUID says the host has them. The best
+// level is chosen once at startup. REVERSI_KERNELS=scalar|sse2|avx2|avx512
+// caps the choice, which is handy for comparing paths.
+// Every variant returns exactly what the scalar one does. The searches
+// (Search.h, MCTS.h, ProofNumber.h, EndgameSolver.h) and both front-ends'
+// board code call through engineKernels, not the scalar Bitboard.h helpers.
+
+const int KERNEL_SCALAR = 0;
+const int KERNEL_SSE2 = 1;
+const int KERNEL_AVX2 = 2;
+const int KERNEL_AVX512 = 3;
+const char* const KERNEL_NAMES[4] = {"scalar", "sse2", "avx2", "avx512"};
+
+const int PATTERN_MAX_SQUARES = 10;
+
+struct EngineKernels {
+    int level;
+    const char* name;
+    uint64_t (*moves)(uint64_t P, uint64_t O);                      // legal moves for P
+    uint64_t (*flips)(int sq, uint64_t P, uint64_t O);              // discs flipped by sq, 0 if illegal
+    int (*discCount)(uint64_t b);
+    // Base-3 index, P = 1, O = 2. For pattern-table evaluators: the built-in
+    // evaluations are not pattern-based, so only ReversiBench calls it for now.
+    uint32_t (*patternIndex)(uint64_t P, uint64_t O, uint64_t mask);
+};
+
+// Base-3 value of each bit pattern of up to PATTERN_MAX_SQUARES squares
+inline uint16_t patternTernary[1 << PATTERN_MAX_SQUARES];
+
+inline void buildPatternTernary() {
+    for (int bits = 0; bits < (1 << PATTERN_MAX_SQUARES); bits++) {
+        int value = 0;
+        int power = 1;
+        for (int i = 0; i < PATTERN_MAX_SQUARES; i++) {
+            if (bits & (1 << i)) value += power;
+            power *= 3;
+        }
+        patternTernary[bits] = (uint16_t)value;
+    }
+}
+
+// ---- Scalar ----
+
+inline int discCountScalar(uint64_t b) {
+    return popCount(b);
+}
+
+inline uint32_t patternIndexScalar(uint64_t P, uint64_t O, uint64_t mask) {
+    uint32_t index = 0;
+    uint32_t power = 1;
+    for (; mask; mask &= mask - 1) {
+        uint64_t bit = mask & (0 - mask);
+        if (P & bit) index += power;
+        else if (O & bit) index += 2 * power;
+        power *= 3;
+    }
+    return index;
+}
+
+#ifdef REVERSI_X86_DISPATCH
+
+// ---- SSE2 ----
+// The vertical flip turns a right shift by 8 / 7 / 9 into a left shift by
+// 8 / 9 / 7, so each 128-bit register holds the real board in the low lane
+// and the flipped board in the high lane, and both move the same way. The
+// edge masks are symmetric under the flip. Horizontal lines stay scalar.
+
+__attribute__((target("sse2")))
+inline __m128i sse2Pair(uint64_t b) {
+    return _mm_set_epi64x((long long)__builtin_bswap64(b), (long long)b);
+}
+
+__attribute__((target("sse2")))
+inline uint64_t sse2Unpair(__m128i v) {
+    uint64_t lo = (uint64_t)_mm_cvtsi128_si64(v);
+    uint64_t hi = (uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(v, v));
+    return lo | __builtin_bswap64(hi);
+}
+
+template <int S>
+__attribute__((target("sse2")))
+inline __m128i sse2MovesAlong(__m128i P, __m128i mask) {
+    __m128i f = _mm_and_si128(mask, _mm_slli_epi64(P, S));
+    f = _mm_or_si128(f, _mm_and_si128(mask, _mm_slli_epi64(f, S)));
+    f = _mm_or_si128(f, _mm_and_si128(mask, _mm_slli_epi64(f, S)));
+    f = _mm_or_si128(f, _mm_and_si128(mask, _mm_slli_epi64(f, S)));
+    f = _mm_or_si128(f, _mm_and_si128(mask, _mm_slli_epi64(f, S)));
+    f = _mm_or_si128(f, _mm_and_si128(mask, _mm_slli_epi64(f, S)));
+    return _mm_slli_epi64(f, S);
+}
+
+__attribute__((target("sse2")))
+inline uint64_t movesSse2(uint64_t P, uint64_t O) {
+    __m128i p = sse2Pair(P);
+    __m128i o = sse2Pair(O);
+    __m128i inner = _mm_and_si128(o, _mm_set1_epi64x((long long)BB_INNER));
+    __m128i rows = _mm_and_si128(o, _mm_set1_epi64x((long long)BB_NOT_EDGE_ROWS));
+    __m128i m = _mm_or_si128(sse2MovesAlong<8>(p, rows),
+                _mm_or_si128(sse2MovesAlong<7>(p, inner), sse2MovesAlong<9>(p, inner)));
+    uint64_t moves = sse2Unpair(m) | movesAlong(P, O & BB_NOT_EDGE_COLS, 1);
+    return moves & ~(P | O);
+}
+
+template <int S>
+__attribute__((target("sse2")))
+inline __m128i sse2FlipsAlong(__m128i m, __m128i P, __m128i mask) {
+    __m128i x = _mm_and_si128(mask, _mm_slli_epi64(m, S));
+    x = _mm_or_si128(x, _mm_and_si128(mask, _mm_slli_epi64(x, S)));
+    x = _mm_or_si128(x, _mm_and_si128(mask, _mm_slli_epi64(x, S)));
+    x = _mm_or_si128(x, _mm_and_si128(mask, _mm_slli_epi64(x, S)));
+    x = _mm_or_si128(x, _mm_and_si128(mask, _mm_slli_epi64(x, S)));
+    x = _mm_or_si128(x, _mm_and_si128(mask, _mm_slli_epi64(x, S)));
+    // Keep the run only where it ends on one of P's discs (no 64-bit compare in SSE2)
+    __m128i zero = _mm_cmpeq_epi32(_mm_and_si128(_mm_slli_epi64(x, S), P), _mm_setzero_si128());
+    zero = _mm_and_si128(zero, _mm_shuffle_epi32(zero, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_andnot_si128(zero, x);
+}
+
+// Horizontal runs from the move square
+inline uint64_t flipsAlongRow(uint64_t m, uint64_t P, uint64_t mask) {
+    uint64_t flips = 0;
+    uint64_t x = mask & (m << 1);
+    x |= mask & (x << 1);
+    x |= mask & (x << 1);
+    x |= mask & (x << 1);
+    x |= mask & (x << 1);
+    x |= mask & (x << 1);
+    if ((x << 1) & P) flips |= x;
+    x = mask & (m >> 1);
+    x |= mask & (x >> 1);
+    x |= mask & (x >> 1);
+    x |= mask & (x >> 1);
+    x |= mask & (x >> 1);
+    x |= mask & (x >> 1);
+    if ((x >> 1) & P) flips |= x;
+    return flips;
+}
+
+__attribute__((target("sse2")))
+inline uint64_t flipsSse2(int sq, uint64_t P, uint64_t O) {
+    __m128i m = sse2Pair(squareBit(sq));
+    __m128i p = sse2Pair(P);
+    __m128i o = sse2Pair(O);
+    __m128i inner = _mm_and_si128(o, _mm_set1_epi64x((long long)BB_INNER));
+    __m128i rows = _mm_and_si128(o, _mm_set1_epi64x((long long)BB_NOT_EDGE_ROWS));
+    __m128i f = _mm_or_si128(sse2FlipsAlong<8>(m, p, rows),
+                _mm_or_si128(sse2FlipsAlong<7>(m, p, inner), sse2FlipsAlong<9>(m, p, inner)));
+    return sse2Unpair(f) | flipsAlongRow(squareBit(sq), P, O & BB_NOT_EDGE_COLS);
+}
+
+// ---- AVX2 (+BMI2, POPCNT) ----
+// One lane per axis (shift 1, 8, 7, 9); left and right runs in two registers.
+
+__attribute__((target("avx2")))
+inline __m256i avx2Shifts() {
+    return _mm256_set_epi64x(9, 7, 8, 1);
+}
+
+__attribute__((target("avx2")))
+inline __m256i avx2Masks(uint64_t O) {
+    return _mm256_and_si256(_mm256_set1_epi64x((long long)O),
+        _mm256_set_epi64x((long long)BB_INNER, (long long)BB_INNER, (long long)BB_NOT_EDGE_ROWS, (long long)BB_NOT_EDGE_COLS));
+}
+
+__attribute__((target("avx2")))
+inline uint64_t avx2OrLanes(__m256i v) {
+    __m128i x = _mm_or_si128(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    x = _mm_or_si128(x, _mm_unpackhi_epi64(x, x));
+    return (uint64_t)_mm_cvtsi128_si64(x);
+}
+
+__attribute__((target("avx2")))
+inline uint64_t movesAvx2(uint64_t P, uint64_t O) {
+    __m256i s = avx2Shifts();
+    __m256i mask = avx2Masks(O);
+    __m256i p = _mm256_set1_epi64x((long long)P);
+
+    __m256i l = _mm256_and_si256(mask, _mm256_sllv_epi64(p, s));
+    __m256i r = _mm256_and_si256(mask, _mm256_srlv_epi64(p, s));
+    for (int i = 0; i < 5; i++) {
+        l = _mm256_or_si256(l, _mm256_and_si256(mask, _mm256_sllv_epi64(l, s)));
+        r = _mm256_or_si256(r, _mm256_and_si256(mask, _mm256_srlv_epi64(r, s)));
+    }
+    __m256i moves = _mm256_or_si256(_mm256_sllv_epi64(l, s), _mm256_srlv_epi64(r, s));
+    return avx2OrLanes(moves) & ~(P | O);
+}
+
+__attribute__((target("avx2")))
+inline uint64_t flipsAvx2(int sq, uint64_t P, uint64_t O) {
+    __m256i s = avx2Shifts();
+    __m256i mask = avx2Masks(O);
+    __m256i m = _mm256_set1_epi64x((long long)squareBit(sq));
+    __m256i p = _mm256_set1_epi64x((long long)P);
+    __m256i zero = _mm256_setzero_si256();
+
+    __m256i l = _mm256_and_si256(mask, _mm256_sllv_epi64(m, s));
+    __m256i r = _mm256_and_si256(mask, _mm256_srlv_epi64(m, s));
+    for (int i = 0; i < 5; i++) {
+        l = _mm256_or_si256(l, _mm256_and_si256(mask, _mm256_sllv_epi64(l, s)));
+        r = _mm256_or_si256(r, _mm256_and_si256(mask, _mm256_srlv_epi64(r, s)));
+    }
+    __m256i lEnd = _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_sllv_epi64(l, s), p), zero);
+    __m256i rEnd = _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_srlv_epi64(r, s), p), zero);
+    return avx2OrLanes(_mm256_or_si256(_mm256_andnot_si256(lEnd, l), _mm256_andnot_si256(rEnd, r)));
+}
+
+__attribute__((target("popcnt")))
+inline int discCountPopcnt(uint64_t b) {
+    return __builtin_popcountll(b);
+}
+
+__attribute__((target("bmi2")))
+inline uint32_t patternIndexBmi2(uint64_t P, uint64_t O, uint64_t mask) {
+    if (__builtin_popcountll(mask) > PATTERN_MAX_SQUARES) return patternIndexScalar(P, O, mask);
+    return patternTernary[_pext_u64(P, mask)] + 2u * patternTernary[_pext_u64(O, mask)];
+}
+
+// ---- AVX-512 ----
+// All eight directions in one register: lanes 0-3 shift left, 4-7 right.
+
+__attribute__((target("avx512f")))
+inline __m512i avx512Shift(__m512i x, __m512i s) {
+    return _mm512_mask_srlv_epi64(_mm512_maskz_sllv_epi64(0x0F, x, s), 0xF0, x, s);
+}
+
+__attribute__((target("avx512f")))
+inline uint64_t avx512OrLanes(__m512i v) {
+    return avx2OrLanes(_mm256_or_si256(_mm512_maskz_extracti64x4_epi64(0xF, v, 0), _mm512_maskz_extracti64x4_epi64(0xF, v, 1)));
+}
+
+__attribute__((target("avx512f")))
+inline uint64_t movesAvx512(uint64_t P, uint64_t O) {
+    __m512i s = _mm512_set_epi64(9, 7, 8, 1, 9, 7, 8, 1);
+    __m512i mask = _mm512_and_si512(_mm512_set1_epi64((long long)O),
+        _mm512_set_epi64((long long)BB_INNER, (long long)BB_INNER, (long long)BB_NOT_EDGE_ROWS, (long long)BB_NOT_EDGE_COLS,
+                         (long long)BB_INNER, (long long)BB_INNER, (long long)BB_NOT_EDGE_ROWS, (long long)BB_NOT_EDGE_COLS));
+    __m512i f = _mm512_and_si512(mask, avx512Shift(_mm512_set1_epi64((long long)P), s));
+    for (int i = 0; i < 5; i++) {
+        f = _mm512_or_si512(f, _mm512_and_si512(mask, avx512Shift(f, s)));
+    }
+    return avx512OrLanes(avx512Shift(f, s)) & ~(P | O);
+}
+
+__attribute__((target("avx512f")))
+inline uint64_t flipsAvx512(int sq, uint64_t P, uint64_t O) {
+    __m512i s = _mm512_set_epi64(9, 7, 8, 1, 9, 7, 8, 1);
+    __m512i mask = _mm512_and_si512(_mm512_set1_epi64((long long)O),
+        _mm512_set_epi64((long long)BB_INNER, (long long)BB_INNER, (long long)BB_NOT_EDGE_ROWS, (long long)BB_NOT_EDGE_COLS,
+                         (long long)BB_INNER, (long long)BB_INNER, (long long)BB_NOT_EDGE_ROWS, (long long)BB_NOT_EDGE_COLS));
+    __m512i x = _mm512_and_si512(mask, avx512Shift(_mm512_set1_epi64((long long)squareBit(sq)), s));
+    for (int i = 0; i < 5; i++) {
+        x = _mm512_or_si512(x, _mm512_and_si512(mask, avx512Shift(x, s)));
+    }
+    __mmask8 ends = _mm512_test_epi64_mask(avx512Shift(x, s), _mm512_set1_epi64((long long)P));
+    return avx512OrLanes(_mm512_maskz_mov_epi64(ends, x));
+}
+
+#endif
+
+// ---- Selection ----
+
+inline int kernelsBestSupported() {
+#ifdef REVERSI_X86_DISPATCH
+    __builtin_cpu_init();
+    bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("popcnt");
+    if (avx2 && __builtin_cpu_supports("avx512f")) return KERNEL_AVX512;
+    if (avx2) return KERNEL_AVX2;
+    if (__builtin_cpu_supports("sse2")) return KERNEL_SSE2;
+#endif
+    return KERNEL_SCALAR;
+}
+
+// Kernels for a level the host supports
+inline EngineKernels kernelsFor(int level) {
+    EngineKernels k = {KERNEL_SCALAR, KERNEL_NAMES[KERNEL_SCALAR], getMoves, getFlips, discCountScalar, patternIndexScalar};
+#ifdef REVERSI_X86_DISPATCH
+    if (level >= KERNEL_SSE2) {
+        k.moves = movesSse2;
+        k.flips = flipsSse2;
+    }
+    if (level >= KERNEL_AVX2) {
+        k.moves = movesAvx2;
+        k.flips = flipsAvx2;
+        k.discCount = discCountPopcnt;
+        k.patternIndex = patternIndexBmi2;
+    }
+    if (level >= KERNEL_AVX512) {
+        k.moves = movesAvx512;
+        k.flips = flipsAvx512;
+    }
+    if (level > KERNEL_AVX512) level = KERNEL_AVX512;
+    k.level = level;
+    k.name = KERNEL_NAMES[level];
+#endif
+    return k;
+}
+
+inline EngineKernels selectKernels() {
+    buildPatternTernary();
+    int level = kernelsBestSupported();
+    const char* cap = getenv("REVERSI_KERNELS");
+    if (cap) {
+        for (int i = 0; i < 4; i++) {
+            if (strcmp(cap, KERNEL_NAMES[i]) == 0 && i < level) level = i;
+        }
+    }
+    return kernelsFor(level);
+}
+
+inline EngineKernels engineKernels = selectKernels();
+
+#endif
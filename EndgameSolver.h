@@ -0,0 +1,307 @@
+#ifndef REVERSI_ENDGAME_SOLVER_H
+#define REVERSI_ENDGAME_SOLVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "Bitboard.h"
+#include "CpuDispatch.h"
+#include "Search.h"
+
+// Exact endgame solver, parallelised with Young Brothers Wait.
+//
+// A node searches its first (best-ordered) child alone. If that does not
+// cut off, the node has at least minSplitEmpties empty squares and some
+// worker is idle, the node becomes a split point: it goes on its owner's
+// queue and idle workers steal it, each taking the next unsearched sibling
+// until none are left. A sibling that fails high marks the split point cut,
+// and every worker below it (found by walking the split chain) abandons its
+// search. Below SOLVER_ORDER_EMPTIES the search is plain alpha-beta without
+// table or ordering.
+//
+// Scores are final disc differences for the side to move (empty squares
+// are not awarded), the same as pnSolveExact.
+
+const int SOLVER_MIN_SPLIT_EMPTIES = 12;
+const int SOLVER_ORDER_EMPTIES = 7;     // move ordering and the table from here up
+const int SOLVER_TABLE_BITS = 22;
+const int SOLVER_CHECK_INTERVAL = 255;  // nodes between cancellation checks
+const uint64_t SOLVER_TT_KEY = 0x2545F4914F6CDD1DULL;
+
+struct SolverSplit {
+    uint64_t P;
+    uint64_t O;
+    int moves[BB_SQUARES];
+    int count;
+    int beta;
+    SolverSplit *parent;
+    std::atomic<int> next{1};       // move 0 was searched before splitting
+    std::atomic<int> working{1};    // the owner plus helpers inside
+    std::atomic<int> alpha;
+    std::atomic<bool> cutoff{false};
+    std::mutex lock;                // guards best and bestMove
+    int best;
+    int bestMove;
+};
+
+struct SolverWorker {
+    std::mutex lock;
+    std::vector<SolverSplit *> splits;  // open split points, oldest first
+    SolverSplit *current = nullptr;     // innermost split this worker is searching under
+    uint64_t nodes = 0;
+    bool cancelled = false;             // current's chain was cut (or stop was set)
+};
+
+struct EndgameSolver {
+    TranspositionTable tt;
+    int threads = 1;
+    int minSplitEmpties = SOLVER_MIN_SPLIT_EMPTIES;
+    const std::atomic<bool> *stop = nullptr;    // optional: abandons the solve
+
+    std::vector<std::unique_ptr<SolverWorker>> workers;
+    std::atomic<int> idle{0};
+    std::atomic<bool> done{false};
+};
+
+struct SolverResult {
+    int score;
+    int bestMove;       // -1 when the side to move must pass or the game is over
+    uint64_t nodes;
+    bool complete;      // false if stop was set before the solve finished
+};
+
+inline bool solverCancelled(const EndgameSolver &solver, const SolverSplit *split) {
+    if (solver.stop && solver.stop->load(std::memory_order_relaxed)) return true;
+    for (; split; split = split->parent) {
+        if (split->cutoff.load(std::memory_order_relaxed)) return true;
+    }
+    return false;
+}
+
+// Small trees: no table, no ordering
+inline int solverLeaf(EndgameSolver &solver, SolverWorker &w, uint64_t P, uint64_t O, int alpha, int beta, bool passed) {
+    if ((++w.nodes & SOLVER_CHECK_INTERVAL) == 0 && solverCancelled(solver, w.current)) w.cancelled = true;
+    if (w.cancelled) return 0;
+
+    uint64_t moves = engineKernels.moves(P, O);
+    if (moves == 0) {
+        if (passed) return engineKernels.discCount(P) - engineKernels.discCount(O);
+        return -solverLeaf(solver, w, O, P, -beta, -alpha, true);
+    }
+    int best = -BB_SQUARES;
+    for (; moves; moves &= moves - 1) {
+        int sq = firstSquare(moves);
+        uint64_t flips = engineKernels.flips(sq, P, O);
+        int score = -solverLeaf(solver, w, O & ~flips, P | flips | squareBit(sq), -beta, -alpha, false);
+        if (score > best) {
+            best = score;
+            if (best > alpha) alpha = best;
+            if (alpha >= beta) break;
+        }
+    }
+    return best;
+}
+
+inline int solverNode(EndgameSolver &solver, SolverWorker &w, uint64_t P, uint64_t O, int alpha, int beta,
+                      bool passed, bool root, int &bestMove);
+
+// Searches moves of split until none are left; used by the owner and by helpers
+inline void solverWorkSplit(EndgameSolver &solver, SolverWorker &w, SolverSplit &split) {
+    SolverSplit *saved = w.current;
+    w.current = &split;
+    for (int i = split.next.fetch_add(1); i < split.count; i = split.next.fetch_add(1)) {
+        if (split.cutoff.load(std::memory_order_relaxed)) break;
+        int sq = split.moves[i];
+        uint64_t flips = engineKernels.flips(sq, split.P, split.O);
+        int alpha = split.alpha.load(std::memory_order_relaxed);
+        int childMove;
+        int score = -solverNode(solver, w, split.O & ~flips, split.P | flips | squareBit(sq), -split.beta, -alpha,
+                                false, false, childMove);
+        if (w.cancelled) break;
+
+        std::lock_guard<std::mutex> guard(split.lock);
+        if (score > split.best) {
+            split.best = score;
+            split.bestMove = sq;
+            if (score > split.alpha.load(std::memory_order_relaxed)) split.alpha.store(score);
+            if (score >= split.beta) split.cutoff.store(true);
+        }
+    }
+    w.current = saved;
+}
+
+// Joins the oldest open split point of another worker; false if there is none
+inline bool solverSteal(EndgameSolver &solver, int self) {
+    int count = (int)solver.workers.size();
+    for (int k = 1; k < count; k++) {
+        SolverWorker &victim = *solver.workers[(self + k) % count];
+        SolverSplit *split = nullptr;
+        {
+            std::lock_guard<std::mutex> guard(victim.lock);
+            for (SolverSplit *s : victim.splits) {
+                if (s->next.load(std::memory_order_relaxed) < s->count && !s->cutoff.load(std::memory_order_relaxed)) {
+                    s->working.fetch_add(1);
+                    split = s;
+                    break;
+                }
+            }
+        }
+        if (split) {
+            SolverWorker &w = *solver.workers[self];
+            solver.idle.fetch_sub(1);
+            w.cancelled = false;
+            solverWorkSplit(solver, w, *split);
+            w.cancelled = false;
+            split->working.fetch_sub(1);
+            solver.idle.fetch_add(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Helper threads: counted as idle whenever they are not inside a split
+inline void solverIdleLoop(EndgameSolver &solver, int self) {
+    solver.idle.fetch_add(1);
+    while (!solver.done.load(std::memory_order_relaxed)) {
+        if (!solverSteal(solver, self)) std::this_thread::yield();
+    }
+    solver.idle.fetch_sub(1);
+}
+
+// Fail-soft disc difference for the side to move; bestMove is set when a move was searched
+inline int solverNode(EndgameSolver &solver, SolverWorker &w, uint64_t P, uint64_t O, int alpha, int beta,
+                      bool passed, bool root, int &bestMove) {
+    bestMove = -1;
+    int empties = BB_SQUARES - engineKernels.discCount(P | O);
+    if (empties < SOLVER_ORDER_EMPTIES && !root) return solverLeaf(solver, w, P, O, alpha, beta, passed);
+    if ((++w.nodes & SOLVER_CHECK_INTERVAL) == 0 && solverCancelled(solver, w.current)) w.cancelled = true;
+    if (w.cancelled) return 0;
+
+    uint64_t moves = engineKernels.moves(P, O);
+    if (moves == 0) {
+        if (passed) return engineKernels.discCount(P) - engineKernels.discCount(O);
+        int ignored;
+        return -solverNode(solver, w, O, P, -beta, -alpha, true, false, ignored);
+    }
+
+    uint64_t key = hashPosition(P, O) ^ SOLVER_TT_KEY;
+    int ttMove = -1;
+    TTEntry entry;
+    if (ttProbe(solver.tt, key, entry) && entry.depth == empties) {
+        if (entry.bestMove != BB_PASS && (moves & squareBit(entry.bestMove))) ttMove = entry.bestMove;
+        if (!root) {
+            if (entry.bound == TT_EXACT) return entry.score;
+            if (entry.bound == TT_LOWER && entry.score >= beta) return entry.score;
+            if (entry.bound == TT_UPPER && entry.score <= alpha) return entry.score;
+        }
+    }
+
+    // Table move first, then fewest replies for the opponent
+    int order[BB_SQUARES];
+    int replies[BB_SQUARES];
+    int count = 0;
+    for (; moves; moves &= moves - 1) {
+        int sq = firstSquare(moves);
+        uint64_t flips = engineKernels.flips(sq, P, O);
+        int r = sq == ttMove ? -1 : engineKernels.discCount(engineKernels.moves(O & ~flips, P | flips | squareBit(sq)));
+        int i = count++;
+        while (i > 0 && replies[i - 1] > r) {
+            order[i] = order[i - 1];
+            replies[i] = replies[i - 1];
+            i--;
+        }
+        order[i] = sq;
+        replies[i] = r;
+    }
+
+    int alphaOrig = alpha;
+    int best = -BB_SQUARES - 1;
+    for (int i = 0; i < count; i++) {
+        int sq = order[i];
+        uint64_t flips = engineKernels.flips(sq, P, O);
+        int childMove;
+        int score = -solverNode(solver, w, O & ~flips, P | flips | squareBit(sq), -beta, -alpha, false, false, childMove);
+        if (w.cancelled) return 0;
+        if (score > best) {
+            best = score;
+            bestMove = sq;
+            if (best > alpha) alpha = best;
+            if (alpha >= beta) break;
+        }
+
+        // Young brothers wait: split only after the eldest has been searched
+        if (i == 0 && count > 1 && empties >= solver.minSplitEmpties && solver.idle.load(std::memory_order_relaxed) > 0) {
+            SolverSplit split;
+            split.P = P;
+            split.O = O;
+            for (int j = 0; j < count; j++) split.moves[j] = order[j];
+            split.count = count;
+            split.beta = beta;
+            split.parent = w.current;
+            split.alpha.store(alpha);
+            split.best = best;
+            split.bestMove = bestMove;
+            {
+                std::lock_guard<std::mutex> guard(w.lock);
+                w.splits.push_back(&split);
+            }
+
+            solverWorkSplit(solver, w, split);
+            {
+                std::lock_guard<std::mutex> guard(w.lock);
+                w.splits.pop_back();
+            }
+            split.working.fetch_sub(1);
+            while (split.working.load() > 0) std::this_thread::yield();
+
+            // Our own cutoff is a result; an ancestor's means the result is unused
+            w.cancelled = solverCancelled(solver, w.current);
+            if (w.cancelled) return 0;
+            best = split.best;
+            bestMove = split.bestMove;
+            break;
+        }
+    }
+
+    if (!solverCancelled(solver, w.current)) {
+        uint8_t bound = best <= alphaOrig ? TT_UPPER : (best >= beta ? TT_LOWER : TT_EXACT);
+        ttStore(solver.tt, key, empties, bound, best, bestMove);
+    }
+    return best;
+}
+
+// Exact score of (P, O) for the side to move within [alpha, beta] (fail-soft
+// outside it), searched with solver.threads threads
+inline SolverResult solveEndgame(EndgameSolver &solver, uint64_t P, uint64_t O, int alpha = -BB_SQUARES, int beta = BB_SQUARES) {
+    if (!solver.tt.slots) ttInit(solver.tt, SOLVER_TABLE_BITS);
+    int threads = solver.threads < 1 ? 1 : solver.threads;
+    solver.workers.clear();
+    for (int t = 0; t < threads; t++) solver.workers.emplace_back(new SolverWorker());
+    solver.idle = 0;
+    solver.done = false;
+
+    std::vector<std::thread> pool;
+    try {
+        for (int t = 1; t < threads; t++) pool.emplace_back(solverIdleLoop, std::ref(solver), t);
+    } catch (const std::system_error &) {
+        // Fewer helpers than asked for; the search itself does not depend on them
+    }
+
+    SolverResult result;
+    SolverWorker &main = *solver.workers[0];
+    result.score = solverNode(solver, main, P, O, alpha, beta, false, true, result.bestMove);
+    result.complete = !main.cancelled;
+    solver.done = true;
+    for (std::thread &t : pool) t.join();
+
+    result.nodes = 0;
+    for (const auto &w : solver.workers) result.nodes += w->nodes;
+    return result;
+}
+
+#endif
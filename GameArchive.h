@@ -0,0 +1,415 @@
+#ifndef REVERSI_GAME_ARCHIVE_H
+#define REVERSI_GAME_ARCHIVE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Bitboard.h"
+#ifdef _WIN32
+    #include <climits>
+    #include <fstream>
+    #include <io.h>
+    #include <sys/locking.h>
+#else
+    #include <fcntl.h>
+    #include <sys/file.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// Append-only game archive.
+//
+// File   = "RVGA" + uint32 version, followed by blocks.
+// Block  = "RVGB", rawSize, packedSize, gameCount, checksum (uint32 each),
+//          then packedSize bytes of LZ-compressed game records.
+// Record = blackPlayer, whitePlayer, blackDiscs, whiteDiscs (uint8),
+//          startTime (int64, unix seconds), durationMs (uint32),
+//          moveCount (uint8), then one byte per move (row * 8 + col).
+// Passes are not stored: a side with no legal move simply passes on replay.
+
+const uint32_t ARCHIVE_VERSION = 1;
+const size_t ARCHIVE_BLOCK_SIZE = 64 * 1024;
+const int ARCHIVE_HEADER_BYTES = 8;
+const int ARCHIVE_BLOCK_HEADER_BYTES = 20;
+const int ARCHIVE_RECORD_HEADER_BYTES = 17;
+// A block is written once it reaches ARCHIVE_BLOCK_SIZE, so it can run over by one record
+const size_t ARCHIVE_MAX_RAW_SIZE = ARCHIVE_BLOCK_SIZE + ARCHIVE_RECORD_HEADER_BYTES + BB_SQUARES;
+
+const uint8_t ARCHIVE_HUMAN = 0;
+const uint8_t ARCHIVE_MINIMAX = 1;
+const uint8_t ARCHIVE_MCTS = 2;
+
+struct GameHeader {
+    uint8_t blackPlayer;
+    uint8_t whitePlayer;
+    uint8_t blackDiscs;
+    uint8_t whiteDiscs;
+    int64_t startTime;
+    uint32_t durationMs;
+};
+
+inline void putU32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+inline uint32_t getU32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+inline uint32_t archiveChecksum(const uint8_t *data, size_t size) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        h = (h ^ data[i]) * 16777619u;
+    }
+    return h;
+}
+
+// ---- Block compression (LZ77, LZ4-style token stream) ----
+
+inline void lzPutLength(std::vector<uint8_t> &out, size_t len) {
+    while (len >= 255) {
+        out.push_back(255);
+        len -= 255;
+    }
+    out.push_back((uint8_t)len);
+}
+
+inline void lzCompress(const uint8_t *in, size_t size, std::vector<uint8_t> &out) {
+    const int HASH_BITS = 12;
+    const size_t MIN_MATCH = 4;
+    std::vector<uint32_t> table(1 << HASH_BITS, UINT32_MAX);
+    out.clear();
+
+    size_t anchor = 0;
+    size_t pos = 0;
+    while (pos + MIN_MATCH <= size) {
+        uint32_t word;
+        memcpy(&word, in + pos, 4);
+        uint32_t h = (word * 2654435761u) >> (32 - HASH_BITS);
+        uint32_t candidate = table[h];
+        table[h] = (uint32_t)pos;
+
+        if (candidate == UINT32_MAX || pos - candidate > 65535 || memcmp(in + candidate, in + pos, 4) != 0) {
+            pos++;
+            continue;
+        }
+
+        size_t matchLen = MIN_MATCH;
+        while (pos + matchLen < size && in[candidate + matchLen] == in[pos + matchLen]) {
+            matchLen++;
+        }
+
+        size_t litLen = pos - anchor;
+        size_t extra = matchLen - MIN_MATCH;
+        out.push_back((uint8_t)(((litLen < 15 ? litLen : 15) << 4) | (extra < 15 ? extra : 15)));
+        if (litLen >= 15) lzPutLength(out, litLen - 15);
+        out.insert(out.end(), in + anchor, in + pos);
+        uint32_t offset = (uint32_t)(pos - candidate);
+        out.push_back((uint8_t)offset);
+        out.push_back((uint8_t)(offset >> 8));
+        if (extra >= 15) lzPutLength(out, extra - 15);
+
+        pos += matchLen;
+        anchor = pos;
+    }
+
+    // Trailing literals end the stream
+    size_t litLen = size - anchor;
+    out.push_back((uint8_t)((litLen < 15 ? litLen : 15) << 4));
+    if (litLen >= 15) lzPutLength(out, litLen - 15);
+    out.insert(out.end(), in + anchor, in + size);
+}
+
+inline bool lzReadLength(const uint8_t *&ip, const uint8_t *end, size_t &len) {
+    uint8_t b;
+    do {
+        if (ip >= end) return false;
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+inline bool lzDecompress(const uint8_t *in, size_t size, uint8_t *out, size_t outSize) {
+    const uint8_t *ip = in;
+    const uint8_t *end = in + size;
+    size_t op = 0;
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+        size_t litLen = token >> 4;
+        if (litLen == 15 && !lzReadLength(ip, end, litLen)) return false;
+        if ((size_t)(end - ip) < litLen || outSize - op < litLen) return false;
+        memcpy(out + op, ip, litLen);
+        ip += litLen;
+        op += litLen;
+        if (ip == end) break;
+
+        if (end - ip < 2) return false;
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t matchLen = (token & 15);
+        if (matchLen == 15 && !lzReadLength(ip, end, matchLen)) return false;
+        matchLen += 4;
+        if (offset == 0 || offset > op || outSize - op < matchLen) return false;
+        for (size_t i = 0; i < matchLen; i++, op++) {
+            out[op] = out[op - offset];
+        }
+    }
+    return op == outSize;
+}
+
+// ---- Streaming writer ----
+// Any number of threads may append; each full block is compressed and
+// written with a single locked append, so separate processes can share a
+// file. Blocks are never rewritten: a crash can only lose the block being
+// appended. Small blocks (one game per run) are merged by archiveCompact.
+
+struct ArchiveWriter {
+    FILE *file = nullptr;
+    std::mutex lock;
+    std::vector<uint8_t> block;
+    uint32_t gameCount = 0;
+};
+
+// Whole-file lock shared by every process writing the archive
+inline void archiveLock(FILE *file) {
+    #ifdef _WIN32
+        // _locking covers the bytes from the current position; it retries for about 10 s
+        fseek(file, 0, SEEK_SET);
+        _locking(_fileno(file), _LK_LOCK, LONG_MAX);
+    #else
+        flock(fileno(file), LOCK_EX);
+    #endif
+}
+
+inline void archiveUnlock(FILE *file) {
+    #ifdef _WIN32
+        fseek(file, 0, SEEK_SET);
+        _locking(_fileno(file), _LK_UNLCK, LONG_MAX);
+    #else
+        flock(fileno(file), LOCK_UN);
+    #endif
+}
+
+inline bool archiveWriteBlock(ArchiveWriter &w) {
+    if (w.gameCount == 0) return true;
+
+    std::vector<uint8_t> packed;
+    lzCompress(w.block.data(), w.block.size(), packed);
+
+    std::vector<uint8_t> out(ARCHIVE_BLOCK_HEADER_BYTES + packed.size());
+    memcpy(out.data(), "RVGB", 4);
+    putU32(&out[4], (uint32_t)w.block.size());
+    putU32(&out[8], (uint32_t)packed.size());
+    putU32(&out[12], w.gameCount);
+    putU32(&out[16], archiveChecksum(w.block.data(), w.block.size()));
+    memcpy(&out[ARCHIVE_BLOCK_HEADER_BYTES], packed.data(), packed.size());
+
+    archiveLock(w.file);
+    fseek(w.file, 0, SEEK_END);
+    if (ftell(w.file) == 0) {
+        uint8_t header[ARCHIVE_HEADER_BYTES];
+        memcpy(header, "RVGA", 4);
+        putU32(&header[4], ARCHIVE_VERSION);
+        fwrite(header, 1, sizeof(header), w.file);
+    }
+    bool ok = fwrite(out.data(), 1, out.size(), w.file) == out.size();
+    ok = fflush(w.file) == 0 && ok;
+    archiveUnlock(w.file);
+
+    w.block.clear();
+    w.gameCount = 0;
+    return ok;
+}
+
+inline bool archiveOpen(ArchiveWriter &w, const std::string &path) {
+    w.file = fopen(path.c_str(), "ab");
+    w.block.clear();
+    w.block.reserve(ARCHIVE_BLOCK_SIZE + 128);
+    w.gameCount = 0;
+    return w.file != nullptr;
+}
+
+inline bool archiveAppendGame(ArchiveWriter &w, const GameHeader &header, const uint8_t *moves, int count) {
+    if (count < 0 || count > BB_SQUARES) return false;
+
+    uint8_t rec[ARCHIVE_RECORD_HEADER_BYTES];
+    rec[0] = header.blackPlayer;
+    rec[1] = header.whitePlayer;
+    rec[2] = header.blackDiscs;
+    rec[3] = header.whiteDiscs;
+    putU32(&rec[4], (uint32_t)(uint64_t)header.startTime);
+    putU32(&rec[8], (uint32_t)((uint64_t)header.startTime >> 32));
+    putU32(&rec[12], header.durationMs);
+    rec[16] = (uint8_t)count;
+
+    std::lock_guard<std::mutex> guard(w.lock);
+    if (!w.file) return false;
+    w.block.insert(w.block.end(), rec, rec + sizeof(rec));
+    w.block.insert(w.block.end(), moves, moves + count);
+    w.gameCount++;
+    if (w.block.size() >= ARCHIVE_BLOCK_SIZE) {
+        return archiveWriteBlock(w);
+    }
+    return true;
+}
+
+inline bool archiveFlush(ArchiveWriter &w) {
+    std::lock_guard<std::mutex> guard(w.lock);
+    return w.file && archiveWriteBlock(w);
+}
+
+inline bool archiveClose(ArchiveWriter &w) {
+    bool ok = archiveFlush(w);
+    std::lock_guard<std::mutex> guard(w.lock);
+    if (w.file) fclose(w.file);
+    w.file = nullptr;
+    return ok;
+}
+
+// ---- Memory-mapped reader ----
+
+struct ArchiveReader {
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    #ifdef _WIN32
+        std::vector<uint8_t> buffer;
+    #endif
+};
+
+inline bool archiveMap(ArchiveReader &r, const std::string &path) {
+    #ifdef _WIN32
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+        r.buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        r.data = r.buffer.data();
+        r.size = r.buffer.size();
+    #else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            close(fd);
+            return false;
+        }
+        void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) return false;
+        madvise(p, st.st_size, MADV_SEQUENTIAL);
+        r.data = (const uint8_t *)p;
+        r.size = st.st_size;
+    #endif
+    return r.size >= (size_t)ARCHIVE_HEADER_BYTES && memcmp(r.data, "RVGA", 4) == 0;
+}
+
+inline void archiveUnmap(ArchiveReader &r) {
+    #ifndef _WIN32
+        if (r.data) munmap((void *)r.data, r.size);
+    #endif
+    r.data = nullptr;
+    r.size = 0;
+}
+
+// Calls visit(header, moves, count) for every game; stops at the first
+// corrupt block. Returns the number of games visited.
+template <typename Visitor>
+uint64_t archiveForEachGame(const ArchiveReader &r, Visitor visit) {
+    std::vector<uint8_t> raw;
+    uint64_t games = 0;
+    size_t pos = ARCHIVE_HEADER_BYTES;
+
+    while (pos + ARCHIVE_BLOCK_HEADER_BYTES <= r.size) {
+        const uint8_t *bh = r.data + pos;
+        if (memcmp(bh, "RVGB", 4) != 0) break;
+        uint32_t rawSize = getU32(bh + 4);
+        uint32_t packedSize = getU32(bh + 8);
+        uint32_t gameCount = getU32(bh + 12);
+        pos += ARCHIVE_BLOCK_HEADER_BYTES;
+        if (r.size - pos < packedSize || rawSize > ARCHIVE_MAX_RAW_SIZE) break;
+
+        raw.resize(rawSize);
+        if (!lzDecompress(r.data + pos, packedSize, raw.data(), rawSize)) break;
+        if (archiveChecksum(raw.data(), rawSize) != getU32(bh + 16)) break;
+        pos += packedSize;
+
+        size_t p = 0;
+        for (uint32_t g = 0; g < gameCount; g++) {
+            if (rawSize - p < (size_t)ARCHIVE_RECORD_HEADER_BYTES) return games;
+            const uint8_t *rec = &raw[p];
+            GameHeader header;
+            header.blackPlayer = rec[0];
+            header.whitePlayer = rec[1];
+            header.blackDiscs = rec[2];
+            header.whiteDiscs = rec[3];
+            header.startTime = (int64_t)((uint64_t)getU32(rec + 4) | ((uint64_t)getU32(rec + 8) << 32));
+            header.durationMs = getU32(rec + 12);
+            int count = rec[16];
+            p += ARCHIVE_RECORD_HEADER_BYTES;
+            if (rawSize - p < (size_t)count) return games;
+            visit(header, &raw[p], count);
+            p += count;
+            games++;
+        }
+    }
+    return games;
+}
+
+// Replays a record from the initial position, checking every move is legal
+// and the final disc counts match the header
+inline bool archiveReplayGame(const GameHeader &header, const uint8_t *moves, int count) {
+    uint64_t black = squareBit(3 * 8 + 4) | squareBit(4 * 8 + 3);
+    uint64_t white = squareBit(3 * 8 + 3) | squareBit(4 * 8 + 4);
+    bool blackToMove = true;
+
+    for (int i = 0; i < count; i++) {
+        uint64_t &P = blackToMove ? black : white;
+        uint64_t &O = blackToMove ? white : black;
+        if (getMoves(P, O) == 0) {
+            blackToMove = !blackToMove;
+            if (getMoves(O, P) == 0) return false;
+            i--;
+            continue;
+        }
+        if (moves[i] >= BB_SQUARES || !playMove(moves[i], P, O)) return false;
+        blackToMove = !blackToMove;
+    }
+    return popCount(black) == header.blackDiscs && popCount(white) == header.whiteDiscs;
+}
+
+// Offline compaction: rewrites every readable game into full blocks in
+// path + ".tmp", then renames it over the archive. Run it while no game is
+// being played; a writer that still has the old file open would append to
+// it after the rename. A torn block left by a crash is dropped.
+inline bool archiveCompact(const std::string &path, uint64_t &games) {
+    ArchiveReader reader;
+    games = 0;
+    if (!archiveMap(reader, path)) return false;
+
+    std::string tmp = path + ".tmp";
+    remove(tmp.c_str());
+    ArchiveWriter writer;
+    bool ok = archiveOpen(writer, tmp);
+    if (ok) {
+        games = archiveForEachGame(reader, [&](const GameHeader &header, const uint8_t *moves, int count) {
+            ok = archiveAppendGame(writer, header, moves, count) && ok;
+        });
+        ok = archiveClose(writer) && ok;
+    }
+    archiveUnmap(reader);
+    if (!ok) {
+        remove(tmp.c_str());
+        return false;
+    }
+    #ifdef _WIN32
+        remove(path.c_str());   // rename does not replace an existing file here
+    #endif
+    return rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+#endif
@@ -0,0 +1,207 @@
+#ifndef REVERSI_GAME_REVIEW_H
+#define REVERSI_GAME_REVIEW_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Bitboard.h"
+#include "EndgameSolver.h"
+#include "Search.h"
+#include "Symmetry.h"
+
+// Post-game review: every position of a finished game is searched on a
+// thread pool, and each played move is scored against the best move.
+//
+// Positions with up to REVIEW_SOLVE_EMPTIES empty squares are solved
+// exactly (scores are disc differences); earlier ones have every move
+// scored at REVIEW_DEPTH with the evaluation. Results land in the review
+// one position at a time (done is set last), so a UI can show them as
+// they arrive. Scores are also kept by canonical position in a ReviewMemo
+// that outlives the review, so openings that recur are not searched again.
+
+const int REVIEW_DEPTH = 8;
+const int REVIEW_SOLVE_EMPTIES = 14;
+const int REVIEW_TABLE_BITS = 20;
+const int REVIEW_SOLVER_TABLE_BITS = 18;    // one solver table per worker
+const int16_t REVIEW_UNKNOWN = INT16_MIN;
+
+struct ReviewMove {
+    uint64_t P;             // position before the move, mover first
+    uint64_t O;
+    int move;
+    bool black;
+    bool exact;             // solved to the end rather than searched to REVIEW_DEPTH
+    int playedScore;
+    int bestScore;
+    int bestMove;
+    int loss;               // bestScore - playedScore, never negative
+    std::atomic<bool> done{false};
+};
+
+struct ReviewMemoEntry {
+    uint64_t P;             // canonical
+    uint64_t O;
+    bool exact;
+    int bestScore;
+    int bestMove;           // canonical square
+    int16_t scores[BB_SQUARES];     // per canonical square, REVIEW_UNKNOWN if not searched
+};
+
+struct ReviewMemo {
+    std::mutex lock;
+    std::unordered_map<uint64_t, ReviewMemoEntry> entries;
+};
+
+struct GameReview {
+    ReviewMove moves[BB_SQUARES];
+    int count = 0;
+    int edgeWeight = 0;
+    std::atomic<int> next{0};
+    std::atomic<int> completed{0};
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> workers;
+    TranspositionTable tt;      // shared by the midgame searches
+    ReviewMemo *memo = nullptr;
+};
+
+inline bool reviewMemoFind(ReviewMemo &memo, uint64_t cp, uint64_t co, ReviewMemoEntry &entry) {
+    std::lock_guard<std::mutex> guard(memo.lock);
+    auto it = memo.entries.find(hashPosition(cp, co));
+    if (it == memo.entries.end() || it->second.P != cp || it->second.O != co) return false;
+    entry = it->second;
+    return true;
+}
+
+// Adds the known scores of entry to what the memo already has for the position
+inline void reviewMemoStore(ReviewMemo &memo, const ReviewMemoEntry &entry) {
+    std::lock_guard<std::mutex> guard(memo.lock);
+    ReviewMemoEntry &slot = memo.entries[hashPosition(entry.P, entry.O)];
+    if (slot.P != entry.P || slot.O != entry.O || slot.exact != entry.exact) {
+        slot = entry;
+        return;
+    }
+    for (int sq = 0; sq < BB_SQUARES; sq++) {
+        if (entry.scores[sq] != REVIEW_UNKNOWN) slot.scores[sq] = entry.scores[sq];
+    }
+}
+
+// Fills in one position; false if the review was stopped first
+inline bool reviewPosition(GameReview &review, ReviewMove &m, SearchContext &ctx, EndgameSolver &solver) {
+    uint64_t cp, co;
+    int t = canonicalPosition(m.P, m.O, cp, co);
+    int played = transformSquare(m.move, t);
+    bool exact = BB_SQUARES - popCount(m.P | m.O) <= REVIEW_SOLVE_EMPTIES;
+
+    ReviewMemoEntry entry;
+    bool known = reviewMemoFind(*review.memo, cp, co, entry) && entry.exact == exact;
+    if (!known) {
+        entry.P = cp;
+        entry.O = co;
+        entry.exact = exact;
+        for (int sq = 0; sq < BB_SQUARES; sq++) entry.scores[sq] = REVIEW_UNKNOWN;
+
+        if (exact) {
+            SolverResult best = solveEndgame(solver, cp, co);
+            if (!best.complete) return false;
+            entry.bestScore = best.score;
+            entry.bestMove = best.bestMove;
+            entry.scores[best.bestMove] = (int16_t)best.score;
+        } else {
+            MoveScore scores[BB_SQUARES];
+            int count = 0;
+            for (int depth = 1; depth <= REVIEW_DEPTH; depth++) {
+                count = analyseRootMoves(ctx, cp, co, depth, 0, scores);
+                if (searchStopped(ctx)) return false;
+            }
+            for (int i = 0; i < count; i++) entry.scores[scores[i].move] = (int16_t)scores[i].score;
+            entry.bestScore = scores[0].score;
+            entry.bestMove = scores[0].move;
+        }
+    }
+
+    // An exact entry only knows the moves someone has played (and the best one)
+    if (entry.scores[played] == REVIEW_UNKNOWN) {
+        uint64_t p = cp;
+        uint64_t o = co;
+        playMove(played, p, o);
+        SolverResult reply = solveEndgame(solver, o, p);
+        if (!reply.complete) return false;
+        entry.scores[played] = (int16_t)-reply.score;
+        known = false;
+    }
+    if (!known) reviewMemoStore(*review.memo, entry);
+
+    m.exact = exact;
+    m.bestScore = entry.bestScore;
+    m.bestMove = inverseTransformSquare(entry.bestMove, t);
+    m.playedScore = entry.scores[played];
+    m.loss = m.bestScore > m.playedScore ? m.bestScore - m.playedScore : 0;
+    m.done.store(true, std::memory_order_release);
+    return true;
+}
+
+inline void reviewWorker(GameReview &review) {
+    SearchContext ctx;
+    ctx.tt = &review.tt;
+    ctx.edgeWeight = review.edgeWeight;
+    ctx.stop = &review.stop;
+    EndgameSolver solver;
+    ttInit(solver.tt, REVIEW_SOLVER_TABLE_BITS);
+    solver.stop = &review.stop;
+
+    for (int i = review.next.fetch_add(1); i < review.count; i = review.next.fetch_add(1)) {
+        if (!reviewPosition(review, review.moves[i], ctx, solver)) break;
+        review.completed.fetch_add(1);
+    }
+}
+
+// Cancels a running review and waits for its workers
+inline void reviewStop(GameReview &review) {
+    review.stop = true;
+    for (std::thread &t : review.workers) t.join();
+    review.workers.clear();
+    review.stop = false;
+}
+
+// Replays the game (square per move, passes implied) and starts reviewing it
+inline void reviewStart(GameReview &review, ReviewMemo &memo, const uint8_t *moves, int count, int edgeWeight, int threads) {
+    reviewStop(review);
+    if (!review.tt.slots) ttInit(review.tt, REVIEW_TABLE_BITS);
+    review.memo = &memo;
+    review.edgeWeight = edgeWeight;
+    review.count = 0;
+    review.next = 0;
+    review.completed = 0;
+
+    uint64_t black = squareBit(28) | squareBit(35);
+    uint64_t white = squareBit(27) | squareBit(36);
+    bool blackToMove = true;
+    for (int i = 0; i < count && review.count < BB_SQUARES; i++) {
+        if (getMoves(blackToMove ? black : white, blackToMove ? white : black) == 0) blackToMove = !blackToMove;
+        uint64_t &P = blackToMove ? black : white;
+        uint64_t &O = blackToMove ? white : black;
+        ReviewMove &m = review.moves[review.count];
+        m.P = P;
+        m.O = O;
+        m.move = moves[i];
+        m.black = blackToMove;
+        m.done = false;
+        if (!playMove(moves[i], P, O)) break;
+        review.count++;
+        blackToMove = !blackToMove;
+    }
+
+    if (threads < 1) threads = 1;
+    try {
+        for (int t = 0; t < threads; t++) review.workers.emplace_back(reviewWorker, std::ref(review));
+    } catch (const std::system_error &) {
+        // Fewer workers than asked for
+    }
+    if (review.workers.empty()) reviewWorker(review);
+}
+
+#endif
@@ -0,0 +1,330 @@
+#ifndef REVERSI_MCTS_H
+#define REVERSI_MCTS_H
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "Bitboard.h"
+#include "CpuDispatch.h"
+
+// Parallel Monte Carlo Tree Search (PUCT with a static square-weight prior).
+//
+// Nodes live in one preallocated arena and each node's children occupy a
+// contiguous run of it, so selection scans a single cache-friendly block.
+// Threads descend the shared tree concurrently, using virtual loss to spread
+// out over different lines. The tree is kept between moves: the next search
+// starts from the matching child or grandchild of the previous root.
+
+const uint32_t MCTS_DEFAULT_NODES = 1 << 21;
+const float MCTS_EXPLORATION = 1.5f;
+const int MCTS_VIRTUAL_LOSS = 1;
+const uint64_t MCTS_CORNERS = 0x8100000000000081ULL;
+const uint64_t MCTS_X_SQUARES = 0x0042000000004200ULL;
+
+const int MCTS_SQUARE_WEIGHTS[BB_SQUARES] = {
+    100, -20, 10,  5,  5, 10, -20, 100,
+    -20, -50, -2, -2, -2, -2, -50, -20,
+     10,  -2, -1, -1, -1, -1,  -2,  10,
+      5,  -2, -1, -1, -1, -1,  -2,   5,
+      5,  -2, -1, -1, -1, -1,  -2,   5,
+     10,  -2, -1, -1, -1, -1,  -2,  10,
+    -20, -50, -2, -2, -2, -2, -50, -20,
+    100, -20, 10,  5,  5, 10, -20, 100
+};
+
+struct MCTSNode {
+    std::atomic<uint32_t> visits;
+    std::atomic<uint32_t> wins;         // half points for the player who moved into this node
+    std::atomic<int32_t> virtualLoss;
+    std::atomic<uint8_t> state;         // 0 = leaf, 1 = expanding, 2 = expanded, 3 = leaf for good (arena full)
+    uint8_t move;                       // BB_PASS for a pass
+    uint8_t childCount;
+    float prior;
+    uint32_t firstChild;
+};
+
+struct MCTSTree {
+    std::unique_ptr<MCTSNode[]> nodes;
+    uint32_t capacity = 0;
+    std::atomic<uint32_t> used{0};
+    uint32_t root = 0;
+    uint64_t rootP = 0;
+    uint64_t rootO = 0;
+    bool hasRoot = false;
+};
+
+struct MCTSResult {
+    int move;
+    uint32_t visits;
+    float winRate;
+    uint64_t playouts;
+    uint32_t treeNodes;
+};
+
+inline void mctsInitNode(MCTSNode &node, uint8_t move, float prior) {
+    node.visits.store(0, std::memory_order_relaxed);
+    node.wins.store(0, std::memory_order_relaxed);
+    node.virtualLoss.store(0, std::memory_order_relaxed);
+    node.state.store(0, std::memory_order_relaxed);
+    node.move = move;
+    node.childCount = 0;
+    node.prior = prior;
+    node.firstChild = 0;
+}
+
+inline void mctsInit(MCTSTree &tree, uint32_t capacity = MCTS_DEFAULT_NODES) {
+    tree.nodes.reset(new MCTSNode[capacity]);
+    tree.capacity = capacity;
+    tree.used = 0;
+    tree.hasRoot = false;
+}
+
+inline void mctsReset(MCTSTree &tree, uint64_t P, uint64_t O) {
+    tree.used = 1;
+    tree.root = 0;
+    mctsInitNode(tree.nodes[0], BB_PASS, 1.0f);
+    tree.rootP = P;
+    tree.rootO = O;
+    tree.hasRoot = true;
+}
+
+inline uint64_t mctsRandom(uint64_t &state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+inline int mctsPickSquare(uint64_t moves, uint64_t &rng) {
+    int k = (int)(mctsRandom(rng) % engineKernels.discCount(moves));
+    while (k--) moves &= moves - 1;
+    return firstSquare(moves);
+}
+
+// Lightly biased random game; returns half points for the side to move (2 win, 1 draw, 0 loss)
+inline int mctsPlayout(uint64_t P, uint64_t O, uint64_t &rng) {
+    bool swapped = false;
+    while (true) {
+        uint64_t moves = engineKernels.moves(P, O);
+        if (moves == 0) {
+            if (engineKernels.moves(O, P) == 0) break;
+        } else {
+            if (moves & MCTS_CORNERS) {
+                moves &= MCTS_CORNERS;
+            } else if ((moves & ~MCTS_X_SQUARES) && (mctsRandom(rng) & 3)) {
+                moves &= ~MCTS_X_SQUARES;
+            }
+            int sq = mctsPickSquare(moves, rng);
+            uint64_t flips = engineKernels.flips(sq, P, O);
+            P |= flips | squareBit(sq);
+            O &= ~flips;
+        }
+        uint64_t tmp = P;
+        P = O;
+        O = tmp;
+        swapped = !swapped;
+    }
+    int mine = engineKernels.discCount(swapped ? O : P);
+    int theirs = engineKernels.discCount(swapped ? P : O);
+    return mine > theirs ? 2 : (mine == theirs ? 1 : 0);
+}
+
+// Returns false if the arena is full; the node then stays a leaf and is
+// never tried again, so used cannot grow past capacity
+inline bool mctsExpand(MCTSTree &tree, MCTSNode &node, uint64_t P, uint64_t O) {
+    uint64_t moves = engineKernels.moves(P, O);
+    int count = engineKernels.discCount(moves);
+    if (count == 0 && engineKernels.moves(O, P) != 0) count = 1;
+
+    uint32_t first = tree.used.load(std::memory_order_relaxed);
+    do {
+        if (count > (int)(tree.capacity - first)) {
+            node.state.store(3, std::memory_order_release);
+            return false;
+        }
+    } while (!tree.used.compare_exchange_weak(first, first + count, std::memory_order_relaxed));
+
+    if (moves == 0) {
+        if (count == 1) mctsInitNode(tree.nodes[first], BB_PASS, 1.0f);
+    } else {
+        float total = 0.0f;
+        int i = 0;
+        for (uint64_t m = moves; m; m &= m - 1, i++) {
+            int sq = firstSquare(m);
+            float prior = expf(MCTS_SQUARE_WEIGHTS[sq] / 25.0f);
+            mctsInitNode(tree.nodes[first + i], (uint8_t)sq, prior);
+            total += prior;
+        }
+        for (i = 0; i < count; i++) tree.nodes[first + i].prior /= total;
+    }
+    node.firstChild = first;
+    node.childCount = (uint8_t)count;
+    node.state.store(2, std::memory_order_release);
+    return true;
+}
+
+inline uint32_t mctsSelectChild(const MCTSTree &tree, const MCTSNode &node) {
+    uint32_t parentVisits = node.visits.load(std::memory_order_relaxed) + node.virtualLoss.load(std::memory_order_relaxed);
+    float sqrtParent = sqrtf((float)parentVisits + 1.0f);
+    uint32_t best = node.firstChild;
+    float bestScore = -1e30f;
+
+    for (uint32_t i = node.firstChild; i < node.firstChild + node.childCount; i++) {
+        const MCTSNode &child = tree.nodes[i];
+        uint32_t n = child.visits.load(std::memory_order_relaxed) + MCTS_VIRTUAL_LOSS * child.virtualLoss.load(std::memory_order_relaxed);
+        float q = n ? child.wins.load(std::memory_order_relaxed) / (2.0f * n) : 0.5f;
+        float score = q + MCTS_EXPLORATION * child.prior * sqrtParent / (1.0f + n);
+        if (score > bestScore) {
+            bestScore = score;
+            best = i;
+        }
+    }
+    return best;
+}
+
+inline void mctsIterate(MCTSTree &tree, uint64_t &rng) {
+    uint32_t path[2 * BB_SQUARES + 2];
+    int length = 0;
+    uint64_t P = tree.rootP;
+    uint64_t O = tree.rootO;
+    uint32_t index = tree.root;
+
+    while (true) {
+        MCTSNode &node = tree.nodes[index];
+        node.virtualLoss.fetch_add(1, std::memory_order_relaxed);
+        path[length++] = index;
+        if (node.state.load(std::memory_order_acquire) != 2 || node.childCount == 0) break;
+
+        index = mctsSelectChild(tree, node);
+        int move = tree.nodes[index].move;
+        if (move != BB_PASS) {
+            uint64_t flips = engineKernels.flips(move, P, O);
+            P |= flips | squareBit(move);
+            O &= ~flips;
+        }
+        uint64_t tmp = P;
+        P = O;
+        O = tmp;
+    }
+
+    MCTSNode &leaf = tree.nodes[index];
+    uint8_t expected = 0;
+    if (leaf.state.load(std::memory_order_relaxed) == 0 && leaf.visits.load(std::memory_order_relaxed) > 0
+        && leaf.state.compare_exchange_strong(expected, 1)) {
+        mctsExpand(tree, leaf, P, O);
+    }
+
+    int result;
+    if (leaf.state.load(std::memory_order_acquire) == 2 && leaf.childCount == 0) {
+        int mine = engineKernels.discCount(P);
+        int theirs = engineKernels.discCount(O);
+        result = mine > theirs ? 2 : (mine == theirs ? 1 : 0);
+    } else {
+        result = mctsPlayout(P, O, rng);
+    }
+
+    // result is from the point of view of the side to move at path[i]
+    for (int i = length - 1; i >= 0; i--) {
+        MCTSNode &node = tree.nodes[path[i]];
+        node.wins.fetch_add(2 - result, std::memory_order_relaxed);
+        node.visits.fetch_add(1, std::memory_order_relaxed);
+        node.virtualLoss.fetch_sub(1, std::memory_order_relaxed);
+        result = 2 - result;
+    }
+}
+
+// Moves the root to the child or grandchild matching (P, O), or starts a new tree
+inline void mctsSetRoot(MCTSTree &tree, uint64_t P, uint64_t O) {
+    if (tree.hasRoot && tree.used < tree.capacity / 2) {
+        if (tree.rootP == P && tree.rootO == O) return;
+
+        const MCTSNode &root = tree.nodes[tree.root];
+        if (root.state.load() == 2) {
+            for (uint32_t c = root.firstChild; c < root.firstChild + root.childCount; c++) {
+                const MCTSNode &child = tree.nodes[c];
+                uint64_t cp = tree.rootP, co = tree.rootO;
+                if (child.move != BB_PASS) playMove(child.move, cp, co);
+                if (co == P && cp == O) {
+                    tree.root = c;
+                    tree.rootP = P;
+                    tree.rootO = O;
+                    return;
+                }
+                if (child.state.load() != 2) continue;
+                for (uint32_t g = child.firstChild; g < child.firstChild + child.childCount; g++) {
+                    uint64_t gp = co, go = cp;
+                    if (tree.nodes[g].move != BB_PASS) playMove(tree.nodes[g].move, gp, go);
+                    if (go == P && gp == O) {
+                        tree.root = g;
+                        tree.rootP = P;
+                        tree.rootO = O;
+                        return;
+                    }
+                }
+            }
+        }
+    }
+    mctsReset(tree, P, O);
+}
+
+// Searches for timeMs (or until *interrupt is set) using the given number of
+// threads; returns the most visited move
+inline MCTSResult mctsSearch(MCTSTree &tree, uint64_t P, uint64_t O, int timeMs, int threads,
+                             const std::atomic<bool> *interrupt = nullptr) {
+    MCTSResult result = {-1, 0, 0.0f, 0, 0};
+    uint64_t moves = engineKernels.moves(P, O);
+    if (moves == 0) return result;
+    if (!tree.nodes) mctsInit(tree);
+    if ((moves & (moves - 1)) == 0) {
+        result.move = firstSquare(moves);
+        return result;
+    }
+
+    mctsSetRoot(tree, P, O);
+    MCTSNode &root = tree.nodes[tree.root];
+    uint8_t expected = 0;
+    if (root.state.load() == 0 && root.state.compare_exchange_strong(expected, 1)) {
+        mctsExpand(tree, root, P, O);
+    }
+    uint32_t startVisits = root.visits.load();
+
+    if (threads < 1) threads = 1;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeMs);
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&tree, &stop, deadline, interrupt, t]() {
+            uint64_t rng = 0x9E3779B97F4A7C15ULL * (t + 1) ^ (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+            if (rng == 0) rng = 1;
+            for (uint32_t i = 0; !stop.load(std::memory_order_relaxed); i++) {
+                mctsIterate(tree, rng);
+                if ((i & 63) == 0 && (std::chrono::steady_clock::now() >= deadline
+                                      || (interrupt && interrupt->load(std::memory_order_relaxed)))) {
+                    stop = true;
+                }
+            }
+        });
+    }
+    for (auto &worker : workers) worker.join();
+
+    uint32_t bestVisits = 0;
+    for (uint32_t c = root.firstChild; c < root.firstChild + root.childCount; c++) {
+        const MCTSNode &child = tree.nodes[c];
+        uint32_t visits = child.visits.load();
+        if (result.move < 0 || visits > bestVisits) {
+            bestVisits = visits;
+            result.move = child.move;
+            result.visits = visits;
+            result.winRate = visits ? child.wins.load() / (2.0f * visits) : 0.5f;
+        }
+    }
+    result.playouts = root.visits.load() - startVisits;
+    result.treeNodes = tree.used.load();
+    return result;
+}
+
+#endif
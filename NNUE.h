@@ -0,0 +1,321 @@
+#ifndef REVERSI_NNUE_H
+#define REVERSI_NNUE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "Bitboard.h"
+#include "CpuDispatch.h"
+
+// Optional quantised neural-network evaluator (NNUE style).
+//
+// Inputs are 128 sparse features: "own disc on square s" (s) and "opponent
+// disc on square s" (64 + s). The first layer is kept as an int16
+// accumulator per perspective (black, white) and updated incrementally as
+// discs are placed and flipped, so a move costs a few vector adds instead
+// of a full layer. The rest is a small integer network:
+//   accumulator[128] -> clip 0..127 -> 32 (int8 weights) -> clip 0..127 -> 1
+// Everything is integer arithmetic, so the AVX2, SSE2 and scalar paths give
+// bit-identical scores. The path follows the engine kernels (CpuDispatch.h):
+// AVX2 from the AVX2 level up, whatever the compiler flags.
+//
+// Weight file (little-endian):
+//   "RVNN", version, inputs, hidden1, hidden2 (uint32 each)
+//   int16 featureBias[128], int16 featureWeights[128][128]
+//   int32 hiddenBias[32],   int8 hiddenWeights[32][128]
+//   int32 outputBias,       int8 outputWeights[32]
+//   uint32 FNV-1a checksum of everything after the header
+
+const int NNUE_INPUTS = 2 * BB_SQUARES;
+const int NNUE_HIDDEN1 = 128;
+const int NNUE_HIDDEN2 = 32;
+const int NNUE_CLIP = 127;
+const int NNUE_HIDDEN_SHIFT = 6;
+const int NNUE_OUTPUT_SHIFT = 4;   // output units match evaluateBoard
+const uint32_t NNUE_VERSION = 1;
+
+struct NNUENetwork {
+    alignas(64) int16_t featureWeights[NNUE_INPUTS][NNUE_HIDDEN1];
+    alignas(64) int16_t featureBias[NNUE_HIDDEN1];
+    alignas(64) int16_t hiddenWeights[NNUE_HIDDEN2][NNUE_HIDDEN1];   // int8 in the file, widened on load
+    int32_t hiddenBias[NNUE_HIDDEN2];
+    int32_t outputWeights[NNUE_HIDDEN2];
+    int32_t outputBias = 0;
+    uint32_t id = 0;    // checksum of the weight file, 0 = not loaded
+};
+
+// values[0] is from black's point of view, values[1] from white's
+struct NNUEAccumulator {
+    alignas(64) int16_t values[2][NNUE_HIDDEN1];
+};
+
+inline uint32_t nnueChecksum(const uint8_t *data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// ---- Accumulator kernels ----
+
+inline void nnueAddRowScalar(int16_t *acc, const int16_t *row) {
+    for (int i = 0; i < NNUE_HIDDEN1; i++) acc[i] = (int16_t)(acc[i] + row[i]);
+}
+
+inline void nnueSubAddRowScalar(int16_t *acc, const int16_t *sub, const int16_t *add) {
+    for (int i = 0; i < NNUE_HIDDEN1; i++) acc[i] = (int16_t)(acc[i] - sub[i] + add[i]);
+}
+
+// ---- Dense layers ----
+
+inline int nnueClip(int x) {
+    return x < 0 ? 0 : (x > NNUE_CLIP ? NNUE_CLIP : x);
+}
+
+inline int nnueOutput(const NNUENetwork &net, const int32_t hidden[NNUE_HIDDEN2]) {
+    int32_t sum = net.outputBias;
+    for (int j = 0; j < NNUE_HIDDEN2; j++) {
+        sum += nnueClip(hidden[j] >> NNUE_HIDDEN_SHIFT) * net.outputWeights[j];
+    }
+    return sum >> NNUE_OUTPUT_SHIFT;
+}
+
+inline int nnueForwardScalar(const NNUENetwork &net, const int16_t *acc) {
+    int16_t input[NNUE_HIDDEN1];
+    for (int i = 0; i < NNUE_HIDDEN1; i++) input[i] = (int16_t)nnueClip(acc[i]);
+
+    int32_t hidden[NNUE_HIDDEN2];
+    for (int j = 0; j < NNUE_HIDDEN2; j++) {
+        int32_t sum = net.hiddenBias[j];
+        for (int i = 0; i < NNUE_HIDDEN1; i++) sum += input[i] * net.hiddenWeights[j][i];
+        hidden[j] = sum;
+    }
+    return nnueOutput(net, hidden);
+}
+
+#ifdef REVERSI_X86_DISPATCH
+
+// ---- SSE2 ----
+
+__attribute__((target("sse2")))
+inline void nnueAddRowSse2(int16_t *acc, const int16_t *row) {
+    for (int i = 0; i < NNUE_HIDDEN1; i += 8) {
+        __m128i a = _mm_load_si128((const __m128i *)(acc + i));
+        __m128i w = _mm_load_si128((const __m128i *)(row + i));
+        _mm_store_si128((__m128i *)(acc + i), _mm_add_epi16(a, w));
+    }
+}
+
+__attribute__((target("sse2")))
+inline void nnueSubAddRowSse2(int16_t *acc, const int16_t *sub, const int16_t *add) {
+    for (int i = 0; i < NNUE_HIDDEN1; i += 8) {
+        __m128i a = _mm_load_si128((const __m128i *)(acc + i));
+        a = _mm_sub_epi16(a, _mm_load_si128((const __m128i *)(sub + i)));
+        _mm_store_si128((__m128i *)(acc + i), _mm_add_epi16(a, _mm_load_si128((const __m128i *)(add + i))));
+    }
+}
+
+__attribute__((target("sse2")))
+inline __m128i nnueHorizontalSums(__m128i s0, __m128i s1, __m128i s2, __m128i s3) {
+    // Transpose the four partial sums, then add columns
+    __m128i t0 = _mm_unpacklo_epi32(s0, s1);
+    __m128i t1 = _mm_unpackhi_epi32(s0, s1);
+    __m128i t2 = _mm_unpacklo_epi32(s2, s3);
+    __m128i t3 = _mm_unpackhi_epi32(s2, s3);
+    __m128i a = _mm_add_epi32(_mm_unpacklo_epi64(t0, t2), _mm_unpackhi_epi64(t0, t2));
+    __m128i b = _mm_add_epi32(_mm_unpacklo_epi64(t1, t3), _mm_unpackhi_epi64(t1, t3));
+    return _mm_add_epi32(a, b);
+}
+
+__attribute__((target("sse2")))
+inline int nnueForwardSse2(const NNUENetwork &net, const int16_t *acc) {
+    const int lanes = NNUE_HIDDEN1 / 8;
+    __m128i input[lanes];
+    __m128i zero = _mm_setzero_si128();
+    __m128i clip = _mm_set1_epi16(NNUE_CLIP);
+    for (int k = 0; k < lanes; k++) {
+        __m128i a = _mm_load_si128((const __m128i *)(acc + 8 * k));
+        input[k] = _mm_min_epi16(_mm_max_epi16(a, zero), clip);
+    }
+
+    // Four rows at a time, each input vector loaded once
+    alignas(16) int32_t hidden[NNUE_HIDDEN2];
+    for (int j = 0; j < NNUE_HIDDEN2; j += 4) {
+        __m128i s0 = _mm_setzero_si128(), s1 = s0, s2 = s0, s3 = s0;
+        for (int k = 0; k < lanes; k++) {
+            s0 = _mm_add_epi32(s0, _mm_madd_epi16(input[k], _mm_load_si128((const __m128i *)(net.hiddenWeights[j] + 8 * k))));
+            s1 = _mm_add_epi32(s1, _mm_madd_epi16(input[k], _mm_load_si128((const __m128i *)(net.hiddenWeights[j + 1] + 8 * k))));
+            s2 = _mm_add_epi32(s2, _mm_madd_epi16(input[k], _mm_load_si128((const __m128i *)(net.hiddenWeights[j + 2] + 8 * k))));
+            s3 = _mm_add_epi32(s3, _mm_madd_epi16(input[k], _mm_load_si128((const __m128i *)(net.hiddenWeights[j + 3] + 8 * k))));
+        }
+        __m128i total = _mm_add_epi32(nnueHorizontalSums(s0, s1, s2, s3), _mm_loadu_si128((const __m128i *)(net.hiddenBias + j)));
+        _mm_store_si128((__m128i *)(hidden + j), total);
+    }
+    return nnueOutput(net, hidden);
+}
+
+// ---- AVX2 ----
+
+__attribute__((target("avx2")))
+inline void nnueAddRowAvx2(int16_t *acc, const int16_t *row) {
+    for (int i = 0; i < NNUE_HIDDEN1; i += 16) {
+        __m256i a = _mm256_load_si256((const __m256i *)(acc + i));
+        __m256i w = _mm256_load_si256((const __m256i *)(row + i));
+        _mm256_store_si256((__m256i *)(acc + i), _mm256_add_epi16(a, w));
+    }
+}
+
+__attribute__((target("avx2")))
+inline void nnueSubAddRowAvx2(int16_t *acc, const int16_t *sub, const int16_t *add) {
+    for (int i = 0; i < NNUE_HIDDEN1; i += 16) {
+        __m256i a = _mm256_load_si256((const __m256i *)(acc + i));
+        a = _mm256_sub_epi16(a, _mm256_load_si256((const __m256i *)(sub + i)));
+        _mm256_store_si256((__m256i *)(acc + i), _mm256_add_epi16(a, _mm256_load_si256((const __m256i *)(add + i))));
+    }
+}
+
+__attribute__((target("avx2")))
+inline int nnueForwardAvx2(const NNUENetwork &net, const int16_t *acc) {
+    const int lanes = NNUE_HIDDEN1 / 16;
+    __m256i input[lanes];
+    __m256i zero = _mm256_setzero_si256();
+    __m256i clip = _mm256_set1_epi16(NNUE_CLIP);
+    for (int k = 0; k < lanes; k++) {
+        __m256i a = _mm256_load_si256((const __m256i *)(acc + 16 * k));
+        input[k] = _mm256_min_epi16(_mm256_max_epi16(a, zero), clip);
+    }
+
+    // Four rows at a time, each input vector loaded once
+    alignas(32) int32_t hidden[NNUE_HIDDEN2];
+    for (int j = 0; j < NNUE_HIDDEN2; j += 4) {
+        __m256i s0 = _mm256_setzero_si256(), s1 = s0, s2 = s0, s3 = s0;
+        for (int k = 0; k < lanes; k++) {
+            s0 = _mm256_add_epi32(s0, _mm256_madd_epi16(input[k], _mm256_load_si256((const __m256i *)(net.hiddenWeights[j] + 16 * k))));
+            s1 = _mm256_add_epi32(s1, _mm256_madd_epi16(input[k], _mm256_load_si256((const __m256i *)(net.hiddenWeights[j + 1] + 16 * k))));
+            s2 = _mm256_add_epi32(s2, _mm256_madd_epi16(input[k], _mm256_load_si256((const __m256i *)(net.hiddenWeights[j + 2] + 16 * k))));
+            s3 = _mm256_add_epi32(s3, _mm256_madd_epi16(input[k], _mm256_load_si256((const __m256i *)(net.hiddenWeights[j + 3] + 16 * k))));
+        }
+        __m256i sums = _mm256_hadd_epi32(_mm256_hadd_epi32(s0, s1), _mm256_hadd_epi32(s2, s3));
+        __m128i total = _mm_add_epi32(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+        total = _mm_add_epi32(total, _mm_loadu_si128((const __m128i *)(net.hiddenBias + j)));
+        _mm_store_si128((__m128i *)(hidden + j), total);
+    }
+    return nnueOutput(net, hidden);
+}
+
+#endif
+
+// ---- Selection ----
+
+struct NNUEKernels {
+    const char *name;
+    void (*addRow)(int16_t *acc, const int16_t *row);
+    void (*subAddRow)(int16_t *acc, const int16_t *sub, const int16_t *add);
+    int (*forward)(const NNUENetwork &net, const int16_t *acc);
+};
+
+// Same level as the engine kernels, so REVERSI_KERNELS caps both
+inline NNUEKernels nnueKernelsFor(int level) {
+    NNUEKernels k = {"scalar", nnueAddRowScalar, nnueSubAddRowScalar, nnueForwardScalar};
+#ifdef REVERSI_X86_DISPATCH
+    if (level >= KERNEL_AVX2) {
+        k = {"AVX2", nnueAddRowAvx2, nnueSubAddRowAvx2, nnueForwardAvx2};
+    } else if (level >= KERNEL_SSE2) {
+        k = {"SSE2", nnueAddRowSse2, nnueSubAddRowSse2, nnueForwardSse2};
+    }
+#else
+    (void)level;
+#endif
+    return k;
+}
+
+inline NNUEKernels nnueKernels = nnueKernelsFor(engineKernels.level);
+
+// colour: 0 = black, 1 = white
+inline void nnuePlace(const NNUENetwork &net, NNUEAccumulator &acc, int sq, int colour) {
+    nnueKernels.addRow(acc.values[0], net.featureWeights[colour == 0 ? sq : BB_SQUARES + sq]);
+    nnueKernels.addRow(acc.values[1], net.featureWeights[colour == 1 ? sq : BB_SQUARES + sq]);
+}
+
+// The disc on sq changes to colour
+inline void nnueFlip(const NNUENetwork &net, NNUEAccumulator &acc, int sq, int colour) {
+    int own = sq;
+    int opp = BB_SQUARES + sq;
+    nnueKernels.subAddRow(acc.values[0], net.featureWeights[colour == 0 ? opp : own], net.featureWeights[colour == 0 ? own : opp]);
+    nnueKernels.subAddRow(acc.values[1], net.featureWeights[colour == 1 ? opp : own], net.featureWeights[colour == 1 ? own : opp]);
+}
+
+// Rebuilds both perspectives from scratch
+inline void nnueRefresh(const NNUENetwork &net, NNUEAccumulator &acc, uint64_t black, uint64_t white) {
+    memcpy(acc.values[0], net.featureBias, sizeof(net.featureBias));
+    memcpy(acc.values[1], net.featureBias, sizeof(net.featureBias));
+    for (uint64_t b = black; b; b &= b - 1) nnuePlace(net, acc, firstSquare(b), 0);
+    for (uint64_t w = white; w; w &= w - 1) nnuePlace(net, acc, firstSquare(w), 1);
+}
+
+// Score for colour (0 = black, 1 = white), in evaluateBoard units
+inline int nnueEvaluate(const NNUENetwork &net, const NNUEAccumulator &acc, int colour) {
+    return nnueKernels.forward(net, acc.values[colour]);
+}
+
+// Score for the side owning me, built from scratch (one perspective only),
+// for searches that do not carry an accumulator
+inline int nnueEvaluateBoards(const NNUENetwork &net, uint64_t me, uint64_t opp) {
+    alignas(64) int16_t acc[NNUE_HIDDEN1];
+    memcpy(acc, net.featureBias, sizeof(acc));
+    for (uint64_t b = me; b; b &= b - 1) nnueKernels.addRow(acc, net.featureWeights[firstSquare(b)]);
+    for (uint64_t b = opp; b; b &= b - 1) nnueKernels.addRow(acc, net.featureWeights[BB_SQUARES + firstSquare(b)]);
+    return nnueKernels.forward(net, acc);
+}
+
+inline const char *nnueSimdName() {
+    return nnueKernels.name;
+}
+
+// ---- Weight file ----
+
+inline bool nnueLoad(NNUENetwork &net, const std::string &path) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+
+    const size_t payloadSize = sizeof(int16_t) * NNUE_HIDDEN1 * (1 + NNUE_INPUTS)
+                             + sizeof(int32_t) * NNUE_HIDDEN2 + NNUE_HIDDEN2 * NNUE_HIDDEN1
+                             + sizeof(int32_t) + NNUE_HIDDEN2;
+    uint8_t header[20];
+    std::string payload(payloadSize, '\0');
+    uint32_t checksum = 0;
+    bool ok = fread(header, 1, sizeof(header), file) == sizeof(header)
+           && fread(&payload[0], 1, payloadSize, file) == payloadSize
+           && fread(&checksum, sizeof(checksum), 1, file) == 1;
+    fclose(file);
+    if (!ok) return false;
+
+    uint32_t dims[4];
+    memcpy(dims, header + 4, sizeof(dims));
+    if (memcmp(header, "RVNN", 4) != 0 || dims[0] != NNUE_VERSION || dims[1] != NNUE_INPUTS
+        || dims[2] != NNUE_HIDDEN1 || dims[3] != NNUE_HIDDEN2) {
+        return false;
+    }
+    const uint8_t *data = (const uint8_t *)payload.data();
+    if (nnueChecksum(data, payloadSize) != checksum) return false;
+
+    memcpy(net.featureBias, data, sizeof(net.featureBias));
+    data += sizeof(net.featureBias);
+    memcpy(net.featureWeights, data, sizeof(net.featureWeights));
+    data += sizeof(net.featureWeights);
+    memcpy(net.hiddenBias, data, sizeof(net.hiddenBias));
+    data += sizeof(net.hiddenBias);
+    for (int j = 0; j < NNUE_HIDDEN2; j++) {
+        for (int i = 0; i < NNUE_HIDDEN1; i++) net.hiddenWeights[j][i] = (int8_t)*data++;
+    }
+    memcpy(&net.outputBias, data, sizeof(net.outputBias));
+    data += sizeof(net.outputBias);
+    for (int j = 0; j < NNUE_HIDDEN2; j++) net.outputWeights[j] = (int8_t)*data++;
+
+    net.id = checksum ? checksum : 1;
+    return true;
+}
+
+#endif
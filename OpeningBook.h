@@ -0,0 +1,120 @@
+#ifndef REVERSI_OPENING_BOOK_H
+#define REVERSI_OPENING_BOOK_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Bitboard.h"
+#include "Symmetry.h"
+
+// Compact binary opening book, written by ReversiBook and read by the games.
+//
+// File = "RVBK", version, entry count, search depth (uint32 each), then one
+// 20-byte entry per position sorted by (P, O):
+//   P, O (uint64, canonical, side to move first), score (int16, negamax
+//   value for the side to move), best move (uint8, canonical board,
+//   BB_PASS if none), flags (uint8, reserved)
+// Lookups canonicalise the position and binary-search the entries.
+
+const uint32_t BOOK_VERSION = 1;
+const size_t BOOK_HEADER_SIZE = 16;
+const size_t BOOK_ENTRY_SIZE = 20;
+
+struct BookEntry {
+    uint64_t P;
+    uint64_t O;
+    int16_t score;
+    uint8_t bestMove;
+    uint8_t flags;
+};
+
+struct OpeningBook {
+    std::vector<BookEntry> entries;
+    uint32_t depth = 0;
+};
+
+inline bool bookLess(const BookEntry &a, const BookEntry &b) {
+    return a.P != b.P ? a.P < b.P : a.O < b.O;
+}
+
+inline bool bookLoad(OpeningBook &book, const std::string &path) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+
+    uint8_t header[BOOK_HEADER_SIZE];
+    uint32_t fields[3];
+    bool ok = fread(header, 1, sizeof(header), file) == sizeof(header) && memcmp(header, "RVBK", 4) == 0;
+    if (ok) {
+        memcpy(fields, header + 4, sizeof(fields));
+        ok = fields[0] == BOOK_VERSION;
+    }
+    if (ok) {
+        // The count must match the file, so a corrupt header cannot trigger a huge allocation
+        long dataStart = ftell(file);
+        fseek(file, 0, SEEK_END);
+        long fileSize = ftell(file);
+        fseek(file, dataStart, SEEK_SET);
+        ok = fileSize >= 0 && (uint64_t)fileSize == BOOK_HEADER_SIZE + (uint64_t)fields[1] * BOOK_ENTRY_SIZE;
+    }
+    std::vector<BookEntry> entries;
+    if (ok) {
+        entries.resize(fields[1]);
+        uint8_t raw[BOOK_ENTRY_SIZE];
+        for (uint32_t i = 0; i < fields[1] && ok; i++) {
+            ok = fread(raw, 1, sizeof(raw), file) == sizeof(raw);
+            memcpy(&entries[i].P, raw, 8);
+            memcpy(&entries[i].O, raw + 8, 8);
+            memcpy(&entries[i].score, raw + 16, 2);
+            entries[i].bestMove = raw[18];
+            entries[i].flags = raw[19];
+        }
+    }
+    fclose(file);
+    if (!ok) return false;
+
+    book.entries.swap(entries);
+    book.depth = fields[2];
+    return true;
+}
+
+// Writes to path + ".tmp" and renames, so readers never see half a book
+inline bool bookSave(OpeningBook &book, const std::string &path) {
+    std::sort(book.entries.begin(), book.entries.end(), bookLess);
+    std::string tmp = path + ".tmp";
+    FILE *file = fopen(tmp.c_str(), "wb");
+    if (!file) return false;
+
+    uint8_t header[BOOK_HEADER_SIZE];
+    uint32_t fields[3] = {BOOK_VERSION, (uint32_t)book.entries.size(), book.depth};
+    memcpy(header, "RVBK", 4);
+    memcpy(header + 4, fields, sizeof(fields));
+    bool ok = fwrite(header, 1, sizeof(header), file) == sizeof(header);
+    for (const BookEntry &e : book.entries) {
+        uint8_t raw[BOOK_ENTRY_SIZE];
+        memcpy(raw, &e.P, 8);
+        memcpy(raw + 8, &e.O, 8);
+        memcpy(raw + 16, &e.score, 2);
+        raw[18] = e.bestMove;
+        raw[19] = e.flags;
+        ok = ok && fwrite(raw, 1, sizeof(raw), file) == sizeof(raw);
+    }
+    ok = fclose(file) == 0 && ok;
+    return ok && rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+// Book move for the side owning P, on the caller's board; false if the position is not in the book
+inline bool bookProbe(const OpeningBook &book, uint64_t P, uint64_t O, int &move, int &score) {
+    if (book.entries.empty()) return false;
+    BookEntry key;
+    int t = canonicalPosition(P, O, key.P, key.O);
+    auto it = std::lower_bound(book.entries.begin(), book.entries.end(), key, bookLess);
+    if (it == book.entries.end() || it->P != key.P || it->O != key.O || it->bestMove == BB_PASS) return false;
+    move = inverseTransformSquare(it->bestMove, t);
+    score = it->score;
+    return true;
+}
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef REVERSI_PROFILER_H
+#define REVERSI_PROFILER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Scoped timers, a frame-time record and Chrome trace export for the GUI.
+//
+// Timed scopes are kept in a fixed-size ring (the newest PROFILE_MAX_EVENTS)
+// and can be recorded from any thread. Frame times are kept for the last
+// PROFILE_FRAME_WINDOW frames, for the histogram and p99 shown on screen.
+// profileExportTrace writes the ring as trace-event JSON, which loads in
+// chrome://tracing or ui.perfetto.dev.
+
+const size_t PROFILE_MAX_EVENTS = 1 << 16;
+const size_t PROFILE_FRAME_WINDOW = 600;
+const int PROFILE_HISTOGRAM_BUCKETS = 8;    // < 1, 2, 4, 8, 16, 33, 66 ms, and slower
+const float PROFILE_BUCKET_LIMITS[PROFILE_HISTOGRAM_BUCKETS - 1] = {1.0f, 2.0f, 4.0f, 8.0f, 16.7f, 33.3f, 66.7f};
+
+struct ProfileEvent {
+    const char *name;       // must outlive the profiler (string literals)
+    int64_t startUs;
+    int64_t durationUs;
+    int thread;
+    int64_t value;          // shown as args.value when >= 0
+};
+
+struct Profiler {
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    std::mutex lock;
+    std::vector<ProfileEvent> events;
+    size_t nextEvent = 0;   // ring position once events is full
+    std::vector<float> frameMs;
+    size_t nextFrame = 0;
+    float lastSearchMs = 0.0f;
+};
+
+// Small per-thread number for the trace; the first thread to record is 0
+inline int profileThreadId() {
+    static std::atomic<int> nextId{0};
+    thread_local int id = nextId.fetch_add(1);
+    return id;
+}
+
+inline int64_t profileNowUs(const Profiler &prof) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - prof.epoch).count();
+}
+
+inline void profileRecord(Profiler &prof, const char *name, int64_t startUs, int64_t endUs, int64_t value = -1) {
+    ProfileEvent event = {name, startUs, endUs - startUs, profileThreadId(), value};
+    std::lock_guard<std::mutex> guard(prof.lock);
+    if (prof.events.size() < PROFILE_MAX_EVENTS) {
+        prof.events.push_back(event);
+    } else {
+        prof.events[prof.nextEvent] = event;
+        prof.nextEvent = (prof.nextEvent + 1) % PROFILE_MAX_EVENTS;
+    }
+}
+
+// Records the enclosing scope as one event
+struct ProfileScope {
+    Profiler &prof;
+    const char *name;
+    int64_t startUs;
+    int64_t value = -1;
+
+    ProfileScope(Profiler &p, const char *n) : prof(p), name(n), startUs(profileNowUs(p)) {}
+    ~ProfileScope() { profileRecord(prof, name, startUs, profileNowUs(prof), value); }
+};
+
+inline void profileFrame(Profiler &prof, float ms) {
+    std::lock_guard<std::mutex> guard(prof.lock);
+    if (prof.frameMs.size() < PROFILE_FRAME_WINDOW) {
+        prof.frameMs.push_back(ms);
+    } else {
+        prof.frameMs[prof.nextFrame] = ms;
+        prof.nextFrame = (prof.nextFrame + 1) % PROFILE_FRAME_WINDOW;
+    }
+}
+
+// Frame counts per bucket of PROFILE_BUCKET_LIMITS, and the 99th percentile frame time
+inline void profileFrameStats(Profiler &prof, int histogram[PROFILE_HISTOGRAM_BUCKETS], float &p99) {
+    std::vector<float> frames;
+    {
+        std::lock_guard<std::mutex> guard(prof.lock);
+        frames = prof.frameMs;
+    }
+    std::fill(histogram, histogram + PROFILE_HISTOGRAM_BUCKETS, 0);
+    p99 = 0.0f;
+    if (frames.empty()) return;
+
+    for (float ms : frames) {
+        int bucket = 0;
+        while (bucket < PROFILE_HISTOGRAM_BUCKETS - 1 && ms >= PROFILE_BUCKET_LIMITS[bucket]) bucket++;
+        histogram[bucket]++;
+    }
+    size_t rank = (frames.size() * 99 + 99) / 100 - 1;
+    std::nth_element(frames.begin(), frames.begin() + rank, frames.end());
+    p99 = frames[rank];
+}
+
+inline bool profileExportTrace(Profiler &prof, const std::string &path) {
+    std::vector<ProfileEvent> events;
+    {
+        std::lock_guard<std::mutex> guard(prof.lock);
+        events.assign(prof.events.begin() + prof.nextEvent, prof.events.end());
+        events.insert(events.end(), prof.events.begin(), prof.events.begin() + prof.nextEvent);
+    }
+    FILE *file = fopen(path.c_str(), "w");
+    if (!file) return false;
+
+    int threads = 0;
+    for (const ProfileEvent &e : events) threads = std::max(threads, e.thread + 1);
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (int t = 0; t < threads; t++) {
+        fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s %d\"}},\n",
+                t, t == 0 ? "main" : "worker", t);
+    }
+    for (size_t i = 0; i < events.size(); i++) {
+        const ProfileEvent &e = events[i];
+        fprintf(file, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"dur\":%lld",
+                e.name, e.thread, (long long)e.startUs, (long long)e.durationUs);
+        if (e.value >= 0) fprintf(file, ",\"args\":{\"value\":%lld}", (long long)e.value);
+        fprintf(file, "}%s\n", i + 1 < events.size() ? "," : "");
+    }
+    fprintf(file, "]}\n");
+    return fclose(file) == 0;
+}
+
+#endif
@@ -0,0 +1,309 @@
+#ifndef REVERSI_PROOF_NUMBER_H
+#define REVERSI_PROOF_NUMBER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Bitboard.h"
+#include "CpuDispatch.h"
+
+// Depth-first proof-number search (df-pn) deciding win / draw / loss.
+//
+// Each proof asks whether the root player ends with a disc difference above
+// a target: 0 proves a win, -1 proves at least a draw. Nodes store (phi,
+// delta) from the side to move's point of view; unseen nodes start from
+// mobility (few replies for the opponent = cheap to prove). Positions with
+// PN_SOLVER_EMPTIES or fewer empty squares are settled directly by a small
+// null-window alpha-beta solver. The node table has a fixed size: a full
+// bucket drops its cheapest entry, and a garbage-collection pass removes
+// small subtrees whenever the table passes 90% load.
+
+const int PN_MAX_EMPTIES = 26;
+const int PN_SOLVER_EMPTIES = 10;
+const uint32_t PN_INFINITY = 100000000;
+const uint64_t PN_DEFAULT_NODE_LIMIT = 4000000;
+const uint64_t PN_ENGINE_NODE_LIMIT = 1000000;     // keeps a failed proof under about a second
+const int PN_TABLE_BITS = 20;
+const int PN_BUCKET = 4;
+
+const int PN_WIN = 1;
+const int PN_DRAW = 0;
+const int PN_LOSS = -1;
+const int PN_UNKNOWN = 2;
+
+struct PNEntry {
+    uint64_t P;
+    uint64_t O;
+    uint32_t phi;
+    uint32_t delta;
+    uint32_t work;      // nodes spent below this entry; 0 = empty slot
+    uint8_t attackerToMove;
+};
+
+struct ProofSearch {
+    std::vector<PNEntry> table;
+    uint64_t mask = 0;
+    uint64_t stored = 0;
+    int target = 0;
+    uint64_t nodes = 0;
+    uint64_t nodeLimit = PN_DEFAULT_NODE_LIMIT;
+    const std::atomic<bool> *stop = nullptr;    // optional: aborts like the node limit
+    bool aborted = false;
+};
+
+inline void pnInit(ProofSearch &search, int tableBits = PN_TABLE_BITS) {
+    search.table.assign((size_t)1 << tableBits, PNEntry());
+    search.mask = ((uint64_t)1 << tableBits) - 1;
+    search.stored = 0;
+}
+
+inline void pnClear(ProofSearch &search) {
+    for (PNEntry &e : search.table) e.work = 0;
+    search.stored = 0;
+}
+
+inline uint64_t pnHash(uint64_t P, uint64_t O, bool attackerToMove) {
+    uint64_t h = (P ^ (attackerToMove ? 0x9E3779B97F4A7C15ULL : 0)) * 0xBF58476D1CE4E5B9ULL;
+    h ^= (O + (h >> 29)) * 0x94D049BB133111EBULL;
+    return h ^ (h >> 31);
+}
+
+// Drops every entry below a work threshold, raising it until the table is at most half full
+inline void pnCollectGarbage(ProofSearch &search) {
+    uint32_t threshold = 1;
+    while (search.stored > search.table.size() / 2) {
+        for (PNEntry &e : search.table) {
+            if (e.work != 0 && e.work <= threshold) {
+                e.work = 0;
+                search.stored--;
+            }
+        }
+        threshold *= 2;
+    }
+}
+
+inline bool pnLookup(const ProofSearch &search, uint64_t P, uint64_t O, bool attackerToMove, uint32_t &phi, uint32_t &delta) {
+    const PNEntry *bucket = &search.table[pnHash(P, O, attackerToMove) & search.mask & ~(uint64_t)(PN_BUCKET - 1)];
+    for (int i = 0; i < PN_BUCKET; i++) {
+        if (bucket[i].work != 0 && bucket[i].P == P && bucket[i].O == O && bucket[i].attackerToMove == attackerToMove) {
+            phi = bucket[i].phi;
+            delta = bucket[i].delta;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void pnStore(ProofSearch &search, uint64_t P, uint64_t O, bool attackerToMove, uint32_t phi, uint32_t delta, uint32_t work) {
+    if (work == 0) work = 1;
+    PNEntry *bucket = &search.table[pnHash(P, O, attackerToMove) & search.mask & ~(uint64_t)(PN_BUCKET - 1)];
+    int victim = 0;
+    for (int i = 0; i < PN_BUCKET; i++) {
+        if (bucket[i].work != 0 && bucket[i].P == P && bucket[i].O == O && bucket[i].attackerToMove == attackerToMove) {
+            victim = i;
+            break;
+        }
+        if (bucket[i].work < bucket[victim].work) victim = i;
+    }
+    if (bucket[victim].work == 0) search.stored++;
+    bucket[victim] = {P, O, phi, delta, work, (uint8_t)attackerToMove};
+
+    if (search.stored > search.table.size() * 9 / 10) pnCollectGarbage(search);
+}
+
+// Exact endgame solver: fail-soft disc difference for the side to move
+inline int pnSolveExact(ProofSearch &search, uint64_t P, uint64_t O, int alpha, int beta, bool passed) {
+    search.nodes++;
+    uint64_t moves = engineKernels.moves(P, O);
+    if (moves == 0) {
+        if (passed) return engineKernels.discCount(P) - engineKernels.discCount(O);
+        return -pnSolveExact(search, O, P, -beta, -alpha, true);
+    }
+
+    // Above a few empties, try the moves leaving the opponent fewest replies first
+    int order[BB_SQUARES];
+    int count = 0;
+    int replies[BB_SQUARES];
+    bool sorted = BB_SQUARES - engineKernels.discCount(P | O) > 6;
+    for (; moves; moves &= moves - 1) {
+        int sq = firstSquare(moves);
+        int i = count++;
+        if (sorted) {
+            uint64_t flips = engineKernels.flips(sq, P, O);
+            int r = engineKernels.discCount(engineKernels.moves(O & ~flips, P | flips | squareBit(sq)));
+            while (i > 0 && replies[i - 1] > r) {
+                order[i] = order[i - 1];
+                replies[i] = replies[i - 1];
+                i--;
+            }
+            replies[i] = r;
+        }
+        order[i] = sq;
+    }
+
+    int best = -BB_SQUARES;
+    for (int i = 0; i < count; i++) {
+        int sq = order[i];
+        uint64_t flips = engineKernels.flips(sq, P, O);
+        int score = -pnSolveExact(search, O & ~flips, P | flips | squareBit(sq), -beta, -alpha, false);
+        if (score > best) {
+            best = score;
+            if (best > alpha) alpha = best;
+            if (alpha >= beta) break;
+        }
+    }
+    return best;
+}
+
+inline uint32_t pnAdd(uint32_t a, uint32_t b) {
+    uint32_t sum = a + b;
+    return (sum >= PN_INFINITY || sum < a) ? PN_INFINITY : sum;
+}
+
+// Settles terminal and near-terminal positions; returns false if the node needs expanding
+inline bool pnEvaluateLeaf(ProofSearch &search, uint64_t P, uint64_t O, bool attackerToMove, uint32_t &phi, uint32_t &delta) {
+    bool over = engineKernels.moves(P, O) == 0 && engineKernels.moves(O, P) == 0;
+    int empties = BB_SQUARES - engineKernels.discCount(P | O);
+    if (!over && empties > PN_SOLVER_EMPTIES) return false;
+
+    bool attackerWins;
+    if (over) {
+        int diff = engineKernels.discCount(P) - engineKernels.discCount(O);
+        attackerWins = (attackerToMove ? diff : -diff) > search.target;
+    } else if (attackerToMove) {
+        attackerWins = pnSolveExact(search, P, O, search.target, search.target + 1, false) > search.target;
+    } else {
+        attackerWins = pnSolveExact(search, P, O, -search.target - 1, -search.target, false) < -search.target;
+    }
+
+    bool moverWins = attackerToMove ? attackerWins : !attackerWins;
+    phi = moverWins ? 0 : PN_INFINITY;
+    delta = moverWins ? PN_INFINITY : 0;
+    return true;
+}
+
+// Stored values, or a mobility-based estimate for an unseen node
+inline void pnChildNumbers(const ProofSearch &search, uint64_t P, uint64_t O, bool attackerToMove, uint32_t &phi, uint32_t &delta) {
+    if (pnLookup(search, P, O, attackerToMove, phi, delta)) return;
+    int myMobility = engineKernels.discCount(engineKernels.moves(P, O));
+    int theirMobility = engineKernels.discCount(engineKernels.moves(O, P));
+    phi = 1 + theirMobility;
+    delta = myMobility > 0 ? myMobility : 1;
+}
+
+inline void pnMultipleIterativeDeepening(ProofSearch &search, uint64_t P, uint64_t O, bool attackerToMove, uint32_t thPhi, uint32_t thDelta) {
+    uint64_t startNodes = search.nodes++;
+    uint32_t phi, delta;
+    if (pnEvaluateLeaf(search, P, O, attackerToMove, phi, delta)) {
+        pnStore(search, P, O, attackerToMove, phi, delta, (uint32_t)(search.nodes - startNodes));
+        return;
+    }
+
+    uint64_t childP[BB_SQUARES];
+    uint64_t childO[BB_SQUARES];
+    int count = 0;
+    uint64_t moves = engineKernels.moves(P, O);
+    if (moves == 0) {
+        childP[0] = O;
+        childO[0] = P;
+        count = 1;
+    }
+    for (; moves; moves &= moves - 1) {
+        int sq = firstSquare(moves);
+        uint64_t flips = engineKernels.flips(sq, P, O);
+        childP[count] = O & ~flips;
+        childO[count] = P | flips | squareBit(sq);
+        count++;
+    }
+
+    while (true) {
+        // phi = min child delta, delta = sum of child phi
+        phi = PN_INFINITY;
+        delta = 0;
+        int best = 0;
+        uint32_t bestDelta = PN_INFINITY;
+        uint32_t bestPhi = 0;
+        uint32_t secondDelta = PN_INFINITY;
+        for (int i = 0; i < count; i++) {
+            uint32_t cPhi, cDelta;
+            pnChildNumbers(search, childP[i], childO[i], !attackerToMove, cPhi, cDelta);
+            delta = pnAdd(delta, cPhi);
+            if (cDelta < bestDelta) {
+                secondDelta = bestDelta;
+                bestDelta = cDelta;
+                bestPhi = cPhi;
+                best = i;
+            } else if (cDelta < secondDelta) {
+                secondDelta = cDelta;
+            }
+        }
+        phi = bestDelta;
+
+        if (phi >= thPhi || delta >= thDelta || search.aborted) break;
+        if (search.nodes >= search.nodeLimit || (search.stop && search.stop->load(std::memory_order_relaxed))) {
+            search.aborted = true;
+            break;
+        }
+
+        uint32_t childThPhi = (thDelta >= PN_INFINITY) ? PN_INFINITY : thDelta - delta + bestPhi;
+        // 1 + epsilon trick: let the child run a little past its sibling to avoid thrashing
+        uint32_t secondBound = pnAdd(secondDelta, secondDelta / 4 + 1);
+        uint32_t childThDelta = thPhi < secondBound ? thPhi : secondBound;
+        pnMultipleIterativeDeepening(search, childP[best], childO[best], !attackerToMove, childThPhi, childThDelta);
+    }
+
+    pnStore(search, P, O, attackerToMove, phi, delta, (uint32_t)(search.nodes - startNodes));
+}
+
+// 1 if the side to move can finish more than target discs ahead, 0 if not, -1 if the node limit ran out (or stop was set)
+inline int pnProve(ProofSearch &search, uint64_t P, uint64_t O, int target) {
+    if (search.table.empty()) pnInit(search);
+    pnClear(search);
+    search.target = target;
+    search.aborted = false;
+
+    pnMultipleIterativeDeepening(search, P, O, true, PN_INFINITY, PN_INFINITY);
+    uint32_t phi, delta;
+    if (search.aborted || !pnLookup(search, P, O, true, phi, delta)) return -1;
+    if (phi == 0) return 1;
+    if (delta == 0) return 0;
+    return -1;
+}
+
+// Root move whose subtree was proven in the last successful pnProve
+inline int pnProvingMove(const ProofSearch &search, uint64_t P, uint64_t O) {
+    for (uint64_t moves = engineKernels.moves(P, O); moves; moves &= moves - 1) {
+        int sq = firstSquare(moves);
+        uint64_t flips = engineKernels.flips(sq, P, O);
+        uint32_t phi, delta;
+        if (pnLookup(search, O & ~flips, P | flips | squareBit(sq), false, phi, delta) && delta == 0) {
+            return sq;
+        }
+    }
+    return -1;
+}
+
+// Game-theoretic result for the side to move: PN_WIN, PN_DRAW, PN_LOSS or PN_UNKNOWN.
+// bestMove is set to a move achieving a win or draw (-1 otherwise).
+inline int pnSolve(ProofSearch &search, uint64_t P, uint64_t O, int &bestMove) {
+    bestMove = -1;
+    search.nodes = 0;
+    if (engineKernels.moves(P, O) == 0) return PN_UNKNOWN;
+
+    int win = pnProve(search, P, O, 0);
+    if (win == 1) {
+        bestMove = pnProvingMove(search, P, O);
+        return bestMove >= 0 ? PN_WIN : PN_UNKNOWN;
+    }
+    if (win < 0) return PN_UNKNOWN;
+
+    int draw = pnProve(search, P, O, -1);
+    if (draw == 1) {
+        bestMove = pnProvingMove(search, P, O);
+        return bestMove >= 0 ? PN_DRAW : PN_UNKNOWN;
+    }
+    return draw == 0 ? PN_LOSS : PN_UNKNOWN;
+}
+
+#endif
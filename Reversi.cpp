@@ -1,382 +1,513 @@
 #include <iostream>
 #include <string>
+#include <chrono>
+#include <ctime>
+#include <atomic>
+#include <csignal>
+#include <deque>
+#include <thread>
+#include <vector>
+#include "GameArchive.h"
+#include "ReversiEngine.h"
+#include "Search.h"
 #ifdef _WIN32
     #include <windows.h>
+    #ifndef ENABLE_VIRTUAL_TERMINAL_PROCESSING
+        #define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x0004
+    #endif
 #else
+    #include <cerrno>
     #include <cstdlib>
+    #include <poll.h>
+    #include <termios.h>
+    #include <unistd.h>
 #endif
 
 using namespace std;
 
-const int BOARD_SIZE = 8;
-const int EMPTY = 0;
-const int BLACK = 1;
-const int WHITE = 2;
-const int MAX_DEPTH = 4;
+const char* ARCHIVE_FILE = "reversi_games.rvga";
+const char* CACHE_FILE = "reversi.cache";
+const int ANALYSIS_DEPTH = 6;
+const int FRAME_INTERVAL_MS = 100;
 
-int board[BOARD_SIZE][BOARD_SIZE];
-int moveCount = 0;
+TranspositionTable analysisTable;
+string hintText;
 
-// Forward declarations
-void countPieces(int &blackCount, int &whiteCount);
+// Moves of the game in progress, saved to the archive when it ends
+uint8_t recordedMoves[BOARD_SIZE * BOARD_SIZE];
+int recordedMoveCount = 0;
 
-void initBoard() {
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            board[i][j] = EMPTY;
-        }
-    }
-    board[3][3] = WHITE;
-    board[3][4] = BLACK;
-    board[4][3] = BLACK;
-    board[4][4] = WHITE;
-    moveCount = 4;
+// Board as last shown. While the AI thinks, the engine thread owns board
+// and the front-end draws from this copy.
+int viewBoard[BOARD_SIZE][BOARD_SIZE];
+int viewBlack = 0;
+int viewWhite = 0;
+
+// Screen rows as the terminal currently shows them
+vector<string> shownRows;
+int shownCursor = 0;
+
+volatile sig_atomic_t interruptRequested = 0;
+#ifndef _WIN32
+termios savedTerminal;
+bool terminalRaw = false;
+#endif
+
+void onInterrupt(int) {
+    interruptRequested = 1;
 }
 
-void clearScreen() {
+// Keys are read one at a time without echo; the prompt row shows the typed line
+void setupTerminal() {
     #ifdef _WIN32
-        // Windows-specific console clearing
         HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-        COORD coordScreen = {0, 0};
-        DWORD cCharsWritten;
-        CONSOLE_SCREEN_BUFFER_INFO csbi;
-        DWORD dwConSize;
-        
-        if (!GetConsoleScreenBufferInfo(hConsole, &csbi)) {
-            return;
+        DWORD mode;
+        if (GetConsoleMode(hConsole, &mode)) {
+            SetConsoleMode(hConsole, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
         }
-        
-        dwConSize = csbi.dwSize.X * csbi.dwSize.Y;
-        
-        FillConsoleOutputCharacter(hConsole, (TCHAR)' ', dwConSize, coordScreen, &cCharsWritten);
-        GetConsoleScreenBufferInfo(hConsole, &csbi);
-        FillConsoleOutputAttribute(hConsole, csbi.wAttributes, dwConSize, coordScreen, &cCharsWritten);
-        SetConsoleCursorPosition(hConsole, coordScreen);
     #else
-        // Linux/Unix - use ANSI escape codes
-        cout << "\033[2J\033[1;1H";
-        cout.flush();
+        if (tcgetattr(STDIN_FILENO, &savedTerminal) == 0) {
+            termios raw = savedTerminal;
+            raw.c_lflag &= ~(ICANON | ECHO);
+            raw.c_cc[VMIN] = 1;
+            raw.c_cc[VTIME] = 0;
+            terminalRaw = tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0;
+        }
     #endif
+    signal(SIGINT, onInterrupt);
 }
 
-void displayBoard() {
-    clearScreen();  // Clear previous board display
-    
-    // Display game title and instructions
-    cout << "\n╔═══════════════════════════════════════════════════════════════╗\n";
-    cout << "║              REVERSI (OTHELLO) - AI GAME                      ║\n";
-    cout << "╠═══════════════════════════════════════════════════════════════╣\n";
-    cout << "║  You are BLACK ⚫  |  AI is WHITE ⚪                          ║\n";
-    cout << "║  Enter moves as: A1, B2, C3, etc.                             ║\n";
-    cout << "╚═══════════════════════════════════════════════════════════════╝\n";
-    
-    // Display current score
-    int blackCount, whiteCount;
-    countPieces(blackCount, whiteCount);
-    cout << "\n  Score - Black (⚫): " << blackCount << "  |  White (⚪): " << whiteCount << "\n";
-    
-    // Top border with column labels
-    cout << "\n    A    B    C    D    E    F    G    H\n";
-    cout << "  ╔════╦════╦════╦════╦════╦════╦════╦════╗\n";
-    
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        cout << (i + 1) << " ║";
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            if (board[i][j] == BLACK) {
-                cout << " ⚫";
-            } else if (board[i][j] == WHITE) {
-                cout << " ⚪";
-            } else {
-                cout << "   ";
-            }
-            cout << " ║";
-        }
-        cout << " " << "\n";
-        
-        if (i < BOARD_SIZE - 1) {
-            cout << "  ╠════╬════╬════╬════╬════╬════╬════╬════╣\n";
+void restoreTerminal() {
+    #ifndef _WIN32
+        if (terminalRaw) {
+            tcsetattr(STDIN_FILENO, TCSANOW, &savedTerminal);
+            terminalRaw = false;
         }
-    }
-    
-    // Bottom border with column labels
-    cout << "  ╚════╩════╩════╩════╩════╩════╩════╩════╝\n";
+    #endif
 }
 
-bool isInBounds(int row, int col) {
-    return row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE;
+void writeOutput(const string &text) {
+    #ifdef _WIN32
+        DWORD written;
+        WriteFile(GetStdHandle(STD_OUTPUT_HANDLE), text.data(), (DWORD)text.size(), &written, nullptr);
+    #else
+        size_t offset = 0;
+        while (offset < text.size()) {
+            ssize_t n = write(STDOUT_FILENO, text.data() + offset, text.size() - offset);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return;
+            offset += n;
+        }
+    #endif
 }
 
-bool checkDirection(int row, int col, int dr, int dc, int player) {
-    int opponent = (player == BLACK) ? WHITE : BLACK;
-    int r = row + dr;
-    int c = col + dc;
-    bool foundOpponent = false;
-    
-    while (isInBounds(r, c)) {
-        if (board[r][c] == EMPTY) {
-            return false;
-        }
-        if (board[r][c] == opponent) {
-            foundOpponent = true;
-        } else if (board[r][c] == player) {
-            return foundOpponent;
+// Adds a typed character to line; Enter moves the finished line to lines
+void feedInput(char c, string &line, deque<string> &lines) {
+    static char previous = 0;
+    bool crlf = previous == '\r' && c == '\n';
+    previous = c;
+    if (c == '\r' || c == '\n') {
+        if (!crlf) {
+            lines.push_back(line);
+            line.clear();
         }
-        r += dr;
-        c += dc;
+    } else if (c == 8 || c == 127) {
+        while (!line.empty() && (line.back() & 0xC0) == 0x80) line.pop_back();
+        if (!line.empty()) line.pop_back();
+    } else if ((unsigned char)c >= 32) {
+        line += c;
     }
-    return false;
 }
 
-bool isValidMove(int row, int col, int player) {
-    if (!isInBounds(row, col) || board[row][col] != EMPTY) {
-        return false;
-    }
-    
-    int directions[8][2] = {{-1,-1},{-1,0},{-1,1},{0,-1},{0,1},{1,-1},{1,0},{1,1}};
-    
-    for (int i = 0; i < 8; i++) {
-        if (checkDirection(row, col, directions[i][0], directions[i][1], player)) {
+// Waits up to timeoutMs for keys; returns false once input has ended
+bool pollInput(string &line, deque<string> &lines, int timeoutMs) {
+    char buffer[256];
+    #ifdef _WIN32
+        HANDLE hInput = GetStdHandle(STD_INPUT_HANDLE);
+        DWORD mode;
+        if (GetConsoleMode(hInput, &mode)) {
+            if (WaitForSingleObject(hInput, timeoutMs) != WAIT_OBJECT_0) return true;
+            INPUT_RECORD records[64];
+            DWORD events;
+            if (!ReadConsoleInputA(hInput, records, 64, &events)) return false;
+            for (DWORD i = 0; i < events; i++) {
+                const KEY_EVENT_RECORD &key = records[i].Event.KeyEvent;
+                if (records[i].EventType != KEY_EVENT || !key.bKeyDown || key.uChar.AsciiChar == 0) continue;
+                for (WORD r = 0; r < key.wRepeatCount; r++) feedInput(key.uChar.AsciiChar, line, lines);
+            }
             return true;
         }
-    }
-    return false;
+        DWORD available = 0;
+        if (PeekNamedPipe(hInput, nullptr, 0, nullptr, &available, nullptr) && available == 0) {
+            Sleep(timeoutMs);
+            return true;
+        }
+        DWORD count = 0;
+        if (!ReadFile(hInput, buffer, sizeof(buffer), &count, nullptr) || count == 0) return false;
+    #else
+        pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+        if (poll(&pfd, 1, timeoutMs) <= 0) return true;
+        ssize_t count = read(STDIN_FILENO, buffer, sizeof(buffer));
+        if (count < 0) return errno == EINTR || errno == EAGAIN;
+        if (count == 0) return false;
+    #endif
+    for (int i = 0; i < (int)count; i++) feedInput(buffer[i], line, lines);
+    return true;
 }
 
-void flipDirection(int row, int col, int dr, int dc, int player) {
-    int opponent = (player == BLACK) ? WHITE : BLACK;
-    int r = row + dr;
-    int c = col + dc;
-    
-    while (isInBounds(r, c) && board[r][c] == opponent) {
-        board[r][c] = player;
-        r += dr;
-        c += dc;
+int displayWidth(const string &text) {
+    int width = 0;
+    for (char c : text) {
+        if ((c & 0xC0) != 0x80) width++;
     }
+    return width;
 }
 
-void makeMove(int row, int col, int player) {
-    board[row][col] = player;
-    moveCount++;
-    
-    int directions[8][2] = {{-1,-1},{-1,0},{-1,1},{0,-1},{0,1},{1,-1},{1,0},{1,1}};
-    
-    for (int i = 0; i < 8; i++) {
-        if (checkDirection(row, col, directions[i][0], directions[i][1], player)) {
-            flipDirection(row, col, directions[i][0], directions[i][1], player);
-        }
-    }
+string squareName(int sq) {
+    return string(1, (char)('A' + sq % BOARD_SIZE)) + to_string(sq / BOARD_SIZE + 1);
 }
 
-bool hasValidMoves(int player) {
+void snapshotBoard() {
     for (int i = 0; i < BOARD_SIZE; i++) {
         for (int j = 0; j < BOARD_SIZE; j++) {
-            if (isValidMove(i, j, player)) {
-                return true;
-            }
+            viewBoard[i][j] = board[i][j];
         }
     }
-    return false;
+    countPieces(viewBlack, viewWhite);
 }
 
-void countPieces(int &blackCount, int &whiteCount) {
-    blackCount = 0;
-    whiteCount = 0;
+// Screen rows: title, score, board, messages (hintText), status line, prompt
+vector<string> buildFrame(const string &status, const string &prompt) {
+    vector<string> rows;
+    rows.push_back("");
+    rows.push_back("╔═══════════════════════════════════════════════════════════════╗");
+    rows.push_back("║              REVERSI (OTHELLO) - AI GAME                      ║");
+    rows.push_back("╠═══════════════════════════════════════════════════════════════╣");
+    rows.push_back("║  You are BLACK ⚫  |  AI is WHITE ⚪                          ║");
+    rows.push_back("║  Enter moves as: A1, B2, C3, etc.                             ║");
+    rows.push_back("╚═══════════════════════════════════════════════════════════════╝");
+    rows.push_back("");
+    rows.push_back("  Score - Black (⚫): " + to_string(viewBlack) + "  |  White (⚪): " + to_string(viewWhite));
+    rows.push_back("");
+    rows.push_back("    A    B    C    D    E    F    G    H");
+    rows.push_back("  ╔════╦════╦════╦════╦════╦════╦════╦════╗");
+    
     for (int i = 0; i < BOARD_SIZE; i++) {
+        string row = to_string(i + 1) + " ║";
         for (int j = 0; j < BOARD_SIZE; j++) {
-            if (board[i][j] == BLACK) blackCount++;
-            else if (board[i][j] == WHITE) whiteCount++;
+            if (viewBoard[i][j] == BLACK) {
+                row += " ⚫";
+            } else if (viewBoard[i][j] == WHITE) {
+                row += " ⚪";
+            } else {
+                row += "   ";
+            }
+            row += " ║";
+        }
+        rows.push_back(row);
+        
+        if (i < BOARD_SIZE - 1) {
+            rows.push_back("  ╠════╬════╬════╬════╬════╬════╬════╬════╣");
         }
     }
-}
-
-int evaluateBoard(int player) {
-    int blackCount, whiteCount;
-    countPieces(blackCount, whiteCount);
-    
-    int cornerWeight = 25;
-    int edgeWeight = 5;
-    int score = 0;
+    rows.push_back("  ╚════╩════╩════╩════╩════╩════╩════╝");
     
-    if (player == BLACK) {
-        score = blackCount - whiteCount;
-    } else {
-        score = whiteCount - blackCount;
+    size_t start = 0;
+    while (start < hintText.size()) {
+        size_t end = hintText.find('\n', start);
+        if (end == string::npos) end = hintText.size();
+        rows.push_back(hintText.substr(start, end - start));
+        start = end + 1;
     }
-    
-    int corners[4][2] = {{0,0},{0,7},{7,0},{7,7}};
-    for (int i = 0; i < 4; i++) {
-        int r = corners[i][0];
-        int c = corners[i][1];
-        if (board[r][c] == player) {
-            score += cornerWeight;
-        } else if (board[r][c] != EMPTY) {
-            score -= cornerWeight;
-        }
+    rows.push_back("");
+    rows.push_back(status);
+    rows.push_back(prompt);
+    return rows;
+}
+
+// Rewrites only the rows that changed since the last frame, in one write,
+// and leaves the cursor at column cursorColumn of the last row
+void drawFrame(const vector<string> &rows, int cursorColumn) {
+    string out;
+    if (shownRows.empty()) out += "\033[2J";
+    for (size_t i = 0; i < rows.size() || i < shownRows.size(); i++) {
+        if (i < rows.size() && i < shownRows.size() && rows[i] == shownRows[i]) continue;
+        out += "\033[" + to_string(i + 1) + ";1H";
+        if (i < rows.size()) out += rows[i];
+        out += "\033[K";
     }
+    if (out.empty() && cursorColumn == shownCursor) return;
+    out += "\033[" + to_string(rows.size()) + ";" + to_string(cursorColumn) + "H";
+    shownRows = rows;
+    shownCursor = cursorColumn;
+    writeOutput(out);
+}
+
+string statusLine(chrono::steady_clock::time_point start) {
+    char elapsed[32];
+    snprintf(elapsed, sizeof(elapsed), "%.1fs", chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    string text = string("  AI is thinking (") + elapsed + ")";
     
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        if (board[0][i] == player || board[7][i] == player || 
-            board[i][0] == player || board[i][7] == player) {
-            score += edgeWeight;
-        }
+    int phase = aiStatus.phase;
+    if (phase == AI_PHASE_PROOF) {
+        text += "  proving the endgame";
+    } else if (phase == AI_PHASE_MCTS) {
+        text += "  Monte Carlo tree search";
+    } else if (phase == AI_PHASE_MINIMAX) {
+        text += "  depth " + to_string(aiStatus.depth) + "  nodes " + to_string(aiStatus.nodes.load())
+              + "  moves " + to_string(aiStatus.movesSearched) + "/" + to_string(aiStatus.movesTotal);
+        int best = aiStatus.bestMove;
+        int score = aiStatus.bestScore;
+        if (best >= 0) text += "  best " + squareName(best) + " " + (score > 0 ? "+" : "") + to_string(score);
     }
-    
-    return score;
+    return text + "  [Enter: move now]";
 }
 
-int minimax(int depth, bool isMaximizing, int player, int alpha, int beta) {
-    if (depth == 0 || moveCount == BOARD_SIZE * BOARD_SIZE) {
-        return evaluateBoard(player);
+void recordMove(int row, int col) {
+    if (recordedMoveCount < BOARD_SIZE * BOARD_SIZE) {
+        recordedMoves[recordedMoveCount++] = (uint8_t)(row * BOARD_SIZE + col);
     }
+}
+
+void saveGame(time_t startTime, chrono::steady_clock::time_point startClock) {
+    int blackCount, whiteCount;
+    countPieces(blackCount, whiteCount);
     
-    int opponent = (player == BLACK) ? WHITE : BLACK;
-    int currentPlayer = isMaximizing ? player : opponent;
+    GameHeader header;
+    header.blackPlayer = ARCHIVE_HUMAN;
+    header.whitePlayer = useMCTS ? ARCHIVE_MCTS : ARCHIVE_MINIMAX;
+    header.blackDiscs = (uint8_t)blackCount;
+    header.whiteDiscs = (uint8_t)whiteCount;
+    header.startTime = (int64_t)startTime;
+    header.durationMs = (uint32_t)chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - startClock).count();
     
-    if (!hasValidMoves(currentPlayer)) {
-        if (!hasValidMoves(opponent)) {
-            return evaluateBoard(player);
-        }
-        return minimax(depth - 1, !isMaximizing, player, alpha, beta);
+    ArchiveWriter writer;
+    if (archiveOpen(writer, ARCHIVE_FILE)) {
+        archiveAppendGame(writer, header, recordedMoves, recordedMoveCount);
+        archiveClose(writer);
+    }
+}
+
+// Replays every archived game through isValidMove/makeMove
+int replayArchive(const string &path) {
+    ArchiveReader reader;
+    if (!archiveMap(reader, path)) {
+        cout << "Cannot open archive: " << path << "\n";
+        return 1;
     }
     
-    if (isMaximizing) {
-        int maxEval = -100000;
-        for (int i = 0; i < BOARD_SIZE; i++) {
-            for (int j = 0; j < BOARD_SIZE; j++) {
-                if (isValidMove(i, j, currentPlayer)) {
-                    int tempBoard[BOARD_SIZE][BOARD_SIZE];
-                    int tempMoveCount = moveCount;
-                    for (int x = 0; x < BOARD_SIZE; x++) {
-                        for (int y = 0; y < BOARD_SIZE; y++) {
-                            tempBoard[x][y] = board[x][y];
-                        }
-                    }
-                    
-                    makeMove(i, j, currentPlayer);
-                    int eval = minimax(depth - 1, false, player, alpha, beta);
-                    
-                    for (int x = 0; x < BOARD_SIZE; x++) {
-                        for (int y = 0; y < BOARD_SIZE; y++) {
-                            board[x][y] = tempBoard[x][y];
-                        }
-                    }
-                    moveCount = tempMoveCount;
-                    
-                    maxEval = (eval > maxEval) ? eval : maxEval;
-                    alpha = (alpha > eval) ? alpha : eval;
-                    if (beta <= alpha) break;
-                }
+    auto start = chrono::steady_clock::now();
+    uint64_t invalidGames = 0;
+    uint64_t totalMoves = 0;
+    uint64_t games = archiveForEachGame(reader, [&](const GameHeader &header, const uint8_t *moves, int count) {
+        initBoard();
+        int player = BLACK;
+        bool valid = true;
+        for (int i = 0; i < count && valid; i++) {
+            if (!hasValidMoves(player)) {
+                player = (player == BLACK) ? WHITE : BLACK;
             }
-            if (beta <= alpha) break;
-        }
-        return maxEval;
-    } else {
-        int minEval = 100000;
-        for (int i = 0; i < BOARD_SIZE; i++) {
-            for (int j = 0; j < BOARD_SIZE; j++) {
-                if (isValidMove(i, j, currentPlayer)) {
-                    int tempBoard[BOARD_SIZE][BOARD_SIZE];
-                    int tempMoveCount = moveCount;
-                    for (int x = 0; x < BOARD_SIZE; x++) {
-                        for (int y = 0; y < BOARD_SIZE; y++) {
-                            tempBoard[x][y] = board[x][y];
-                        }
-                    }
-                    
-                    makeMove(i, j, currentPlayer);
-                    int eval = minimax(depth - 1, true, player, alpha, beta);
-                    
-                    for (int x = 0; x < BOARD_SIZE; x++) {
-                        for (int y = 0; y < BOARD_SIZE; y++) {
-                            board[x][y] = tempBoard[x][y];
-                        }
-                    }
-                    moveCount = tempMoveCount;
-                    
-                    minEval = (eval < minEval) ? eval : minEval;
-                    beta = (beta < eval) ? beta : eval;
-                    if (beta <= alpha) break;
-                }
+            int row = moves[i] / BOARD_SIZE;
+            int col = moves[i] % BOARD_SIZE;
+            if (!isValidMove(row, col, player)) {
+                valid = false;
+                break;
             }
-            if (beta <= alpha) break;
+            makeMove(row, col, player);
+            player = (player == BLACK) ? WHITE : BLACK;
         }
-        return minEval;
+        
+        int blackCount, whiteCount;
+        countPieces(blackCount, whiteCount);
+        if (!valid || blackCount != header.blackDiscs || whiteCount != header.whiteDiscs) {
+            invalidGames++;
+        }
+        totalMoves += count;
+    });
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    archiveUnmap(reader);
+    
+    cout << games << " games, " << totalMoves << " moves, " << invalidGames << " invalid";
+    if (seconds > 0) cout << " (" << (uint64_t)(games / seconds) << " games/s)";
+    cout << ", " << engineKernels.name << " kernels\n";
+    return invalidGames == 0 ? 0 : 2;
+}
+
+// Packs the one-game blocks of past runs into full blocks
+int compactArchive(const string &path) {
+    uint64_t games;
+    if (!archiveCompact(path, games)) {
+        cout << "Cannot compact archive: " << path << "\n";
+        return 1;
     }
+    cout << games << " games compacted\n";
+    return 0;
 }
 
-void getAIMove(int &row, int &col, int player) {
-    int bestScore = -100000;
-    int bestRow = -1;
-    int bestCol = -1;
+// Exact scores for every legal move, deepened up to ANALYSIS_DEPTH
+void showHint(int player) {
+    if (!analysisTable.slots) {
+        ttInit(analysisTable);
+    }
     
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            if (isValidMove(i, j, player)) {
-                int tempBoard[BOARD_SIZE][BOARD_SIZE];
-                int tempMoveCount = moveCount;
-                for (int x = 0; x < BOARD_SIZE; x++) {
-                    for (int y = 0; y < BOARD_SIZE; y++) {
-                        tempBoard[x][y] = board[x][y];
-                    }
-                }
-                
-                makeMove(i, j, player);
-                int score = minimax(MAX_DEPTH - 1, false, player, -100000, 100000);
-                
-                for (int x = 0; x < BOARD_SIZE; x++) {
-                    for (int y = 0; y < BOARD_SIZE; y++) {
-                        board[x][y] = tempBoard[x][y];
-                    }
-                }
-                moveCount = tempMoveCount;
-                
-                if (score > bestScore) {
-                    bestScore = score;
-                    bestRow = i;
-                    bestCol = j;
-                }
-            }
-        }
+    uint64_t P, O;
+    boardToBitboards(board, player, P, O);
+    SearchContext ctx;
+    ctx.tt = &analysisTable;
+    ctx.edgeWeight = EDGE_WEIGHT;
+    ctx.net = useNNUE ? &nnueNet : nullptr;
+    
+    MoveScore scores[BOARD_SIZE * BOARD_SIZE];
+    int count = 0;
+    for (int depth = 1; depth <= ANALYSIS_DEPTH; depth++) {
+        count = analyseRootMoves(ctx, P, O, depth, 0, scores);
     }
     
-    row = bestRow;
-    col = bestCol;
+    hintText = "\n  Hint (depth " + to_string(ANALYSIS_DEPTH) + "):";
+    for (int i = 0; i < count; i++) {
+        int row = scores[i].move / BOARD_SIZE;
+        int col = scores[i].move % BOARD_SIZE;
+        hintText += "  ";
+        hintText += (char)('A' + col);
+        hintText += to_string(row + 1) + " " + (scores[i].score > 0 ? "+" : "") + to_string(scores[i].score);
+    }
+    hintText += "\n";
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     // Set console to UTF-8 for proper Unicode character display
     #ifdef _WIN32
         SetConsoleOutputCP(CP_UTF8);
     #endif
     // Linux/Unix typically use UTF-8 by default
     
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--replay" && i + 1 < argc) {
+            return replayArchive(argv[i + 1]);
+        } else if (arg == "--compact" && i + 1 < argc) {
+            return compactArchive(argv[i + 1]);
+        } else if (arg == "--engine" && i + 1 < argc) {
+            useMCTS = string(argv[++i]) == "mcts";
+        } else if (arg == "--nnue" && i + 1 < argc) {
+            useNNUE = nnueLoad(nnueNet, argv[++i]);
+            if (!useNNUE) {
+                cout << "Cannot load network " << argv[i] << "\n";
+                return 1;
+            }
+        } else if (arg == "--book" && i + 1 < argc) {
+            if (!bookLoad(openingBook, argv[++i])) {
+                cout << "Cannot load opening book " << argv[i] << "\n";
+                return 1;
+            }
+        }
+    }
+    
+    bool cacheOpened = cacheOpen(searchCache, CACHE_FILE, useNNUE ? nnueNet.id : EVAL_ID);
     initBoard();
+    snapshotBoard();
+    setupTerminal();
+    hintText = string("\n  Engine kernels: ") + engineKernels.name + "\n";
+    if (!cacheOpened) {
+        hintText += string("  Search cache off: cannot use ") + CACHE_FILE + "\n";
+    } else if (searchCache.path != CACHE_FILE) {
+        hintText += string("  ") + CACHE_FILE + " is for another evaluation, caching in " + searchCache.path + "\n";
+    }
+    time_t startTime = time(nullptr);
+    auto startClock = chrono::steady_clock::now();
     int currentPlayer = BLACK;
-    bool gameOver = false;
     
-    while (!gameOver) {
-        displayBoard();
+    // The AI searches on its own thread; this loop keeps drawing and reading keys
+    thread aiThread;
+    atomic<bool> aiDone(false);
+    bool thinking = false;
+    int aiRow = -1;
+    int aiCol = -1;
+    auto thinkStart = chrono::steady_clock::now();
+    
+    string line;
+    deque<string> lines;
+    bool inputOpen = true;
+    bool quit = false;
+    
+    while (true) {
+        int opponent = (currentPlayer == BLACK) ? WHITE : BLACK;
+        if (thinking && aiDone) {
+            aiThread.join();
+            thinking = false;
+            makeMove(aiRow, aiCol, currentPlayer);
+            recordMove(aiRow, aiCol);
+            snapshotBoard();
+            hintText = "\n  AI played: " + squareName(aiRow * BOARD_SIZE + aiCol) + "\n";
+            currentPlayer = opponent;
+            continue;
+        }
+        
+        bool passing = false;
+        if (!thinking) {
+            if (!hasValidMoves(currentPlayer)) {
+                if (!hasValidMoves(opponent)) break;
+                passing = true;
+            } else if (currentPlayer == WHITE) {
+                aiStatus.stop = false;
+                aiDone = false;
+                thinking = true;
+                thinkStart = chrono::steady_clock::now();
+                aiThread = thread([&aiRow, &aiCol, &aiDone, currentPlayer]() {
+                    getAIMove(aiRow, aiCol, currentPlayer);
+                    aiDone = true;
+                });
+            }
+        }
+        
+        string status;
+        string prompt;
+        if (thinking) {
+            status = statusLine(thinkStart);
+        } else if (passing) {
+            status = string("  ⚠️  ") + ((currentPlayer == BLACK) ? "Black" : "White") + " has no valid moves. Passing...";
+            prompt = "Press Enter to continue...";
+        } else {
+            prompt = "Your turn (BLACK, or HINT): ";
+        }
+        drawFrame(buildFrame(status, prompt + line), displayWidth(prompt + line) + 1);
         
-        if (!hasValidMoves(currentPlayer)) {
-            if (!hasValidMoves((currentPlayer == BLACK) ? WHITE : BLACK)) {
-                gameOver = true;
+        if (interruptRequested) {
+            interruptRequested = 0;
+            if (!thinking) {
+                quit = true;
                 break;
             }
-            cout << "\n⚠️  " << ((currentPlayer == BLACK) ? "Black" : "White") << " has no valid moves. Passing...\n";
-            cout << "Press Enter to continue...";
-            cin.ignore();
-            cin.get();
-            currentPlayer = (currentPlayer == BLACK) ? WHITE : BLACK;
-            continue;
+            aiStatus.stop = true;
         }
         
-        if (currentPlayer == BLACK) {
-            cout << "\nYour turn (BLACK): ";
-            string move;
-            cin >> move;
+        if (thinking) {
+            // Enter on an empty line makes the AI move now; other lines wait for our turn
+            if (!lines.empty() && lines.front().empty()) {
+                lines.pop_front();
+                aiStatus.stop = true;
+            }
+        } else if (!lines.empty()) {
+            string move = lines.front();
+            lines.pop_front();
+            move.erase(0, move.find_first_not_of(" \t"));
+            move.erase(move.find_last_not_of(" \t") + 1);
+            hintText.clear();
+            
+            if (passing) {
+                currentPlayer = opponent;
+                continue;
+            }
+            if (move.empty()) {
+                continue;
+            }
+            if (move == "hint" || move == "HINT" || move == "?") {
+                showHint(currentPlayer);
+                continue;
+            }
             
             if (move.length() < 2) {
-                cout << "Invalid input!\n";
+                hintText = "\n  Invalid input!\n";
                 continue;
             }
             
@@ -385,39 +516,59 @@ int main() {
             int row = move[1] - '1';
             
             if (!isValidMove(row, col, currentPlayer)) {
-                cout << "Invalid move! Try again.\n";
+                hintText = "\n  Invalid move! Try again.\n";
                 continue;
             }
             
             makeMove(row, col, currentPlayer);
-        } else {
-            cout << "\nAI is thinking...\n";
-            int row, col;
-            getAIMove(row, col, currentPlayer);
-            makeMove(row, col, currentPlayer);
-            cout << "AI played: " << (char)('A' + col) << (row + 1) << "\n";
+            recordMove(row, col);
+            snapshotBoard();
+            currentPlayer = opponent;
+            continue;
+        } else if (!inputOpen) {
+            quit = true;
+            break;
         }
         
-        currentPlayer = (currentPlayer == BLACK) ? WHITE : BLACK;
+        if (inputOpen) {
+            inputOpen = pollInput(line, lines, FRAME_INTERVAL_MS);
+        } else {
+            this_thread::sleep_for(chrono::milliseconds(FRAME_INTERVAL_MS));
+        }
+    }
+    
+    if (thinking) {
+        aiStatus.stop = true;
+        aiThread.join();
+    }
+    
+    if (quit) {
+        restoreTerminal();
+        writeOutput("\n");
+        cacheClose(searchCache);
+        return 0;
     }
     
-    displayBoard();
+    snapshotBoard();
+    saveGame(startTime, startClock);
     
     int blackCount, whiteCount;
     countPieces(blackCount, whiteCount);
     
-    cout << "\n=== GAME OVER ===\n";
-    cout << "Final Score:\n";
-    cout << "Black (●): " << blackCount << "\n";
-    cout << "White (○): " << whiteCount << "\n";
-    
+    hintText = "\n  === GAME OVER ===\n  Final Score:\n";
+    hintText += "  Black (●): " + to_string(blackCount) + "\n";
+    hintText += "  White (○): " + to_string(whiteCount) + "\n\n";
     if (blackCount > whiteCount) {
-        cout << "\nYOU WIN!\n";
+        hintText += "  YOU WIN!";
     } else if (whiteCount > blackCount) {
-        cout << "\nAI WINS!\n";
+        hintText += "  AI WINS!";
     } else {
-        cout << "\nIT'S A TIE!\n";
+        hintText += "  IT'S A TIE!";
     }
+    drawFrame(buildFrame("", ""), 1);
+    restoreTerminal();
+    writeOutput("\n");
     
+    cacheClose(searchCache);
     return 0;
 }
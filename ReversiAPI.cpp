@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "ReversiAPI.h"
+#include "Bitboard.h"
+#include "Search.h"
+
+// Implementation of the C interface in ReversiAPI.h, on top of the
+// reentrant bitboard search. A batch shares the handle's transposition
+// table between its workers; each worker has its own SearchContext.
+
+const int API_EDGE_WEIGHT = 5;      // EDGE_WEIGHT of the game's evaluateBoard
+const int API_TABLE_BITS = 20;
+const int API_MAX_TABLE_BITS = 26;     // 16 bytes a slot: 1 GiB
+const int API_MAX_DEPTH = 60;
+
+struct ReversiHandle {
+    uint64_t black = 0;
+    uint64_t white = 0;
+    int sideToMove = REVERSI_BLACK;
+    TranspositionTable tt;
+    std::atomic<bool> stop{false};
+};
+
+static bool validPosition(uint64_t black, uint64_t white, int sideToMove) {
+    return (black & white) == 0 && (sideToMove == REVERSI_BLACK || sideToMove == REVERSI_WHITE);
+}
+
+// Iterative deepening from the side to move; the last completed depth wins
+static void searchPosition(ReversiHandle *handle, const ReversiPosition &position, const ReversiLimits &limits, ReversiResult &result) {
+    uint64_t P = position.sideToMove == REVERSI_BLACK ? position.black : position.white;
+    uint64_t O = position.sideToMove == REVERSI_BLACK ? position.white : position.black;
+
+    SearchContext ctx;
+    ctx.tt = &handle->tt;
+    ctx.edgeWeight = API_EDGE_WEIGHT;
+    ctx.stop = &handle->stop;
+    ctx.nodeLimit = limits.nodeLimit;
+    if (limits.timeMs > 0) {
+        ctx.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(limits.timeMs);
+    }
+
+    uint64_t moves = getMoves(P, O);
+    bool gameOver = moves == 0 && getMoves(O, P) == 0;
+    result.bestMove = moves ? firstSquare(moves) : (gameOver ? REVERSI_NO_MOVE : REVERSI_PASS);
+    result.score = evaluatePosition(P, O, API_EDGE_WEIGHT);
+    result.depth = 0;
+    result.nodes = 0;
+    if (gameOver) return;
+
+    int maxDepth = std::min(limits.depth, API_MAX_DEPTH);
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        int move = REVERSI_PASS;
+        int score;
+        if (moves) {
+            MoveScore scores[BB_SQUARES];
+            analyseRootMoves(ctx, P, O, depth, 1, scores);
+            if (searchStopped(ctx)) break;
+            move = scores[0].move;
+            score = scores[0].score;
+        } else {
+            score = searchNegamax(ctx, P, O, depth, -SEARCH_INFINITY, SEARCH_INFINITY, true);
+            if (searchStopped(ctx)) break;
+        }
+        result.bestMove = move;
+        result.score = score;
+        result.depth = depth;
+    }
+    result.nodes = ctx.nodes;
+}
+
+extern "C" {
+
+int reversiApiVersion(void) {
+    return REVERSI_API_VERSION;
+}
+
+ReversiHandle *reversiCreate(int tableBits) {
+    ReversiHandle *handle = new (std::nothrow) ReversiHandle();
+    if (!handle) return nullptr;
+    if (tableBits <= 0) tableBits = API_TABLE_BITS;
+    if (tableBits > API_MAX_TABLE_BITS) tableBits = API_MAX_TABLE_BITS;
+    try {
+        ttInit(handle->tt, tableBits);
+    } catch (const std::bad_alloc &) {
+        // No exception may cross into the host
+        delete handle;
+        return nullptr;
+    }
+    reversiSetBitboards(handle, squareBit(28) | squareBit(35), squareBit(27) | squareBit(36), REVERSI_BLACK);
+    return handle;
+}
+
+void reversiDestroy(ReversiHandle *handle) {
+    delete handle;
+}
+
+int reversiSetPosition(ReversiHandle *handle, const char *text) {
+    if (!handle || !text) return REVERSI_ERROR_ARGUMENT;
+    uint64_t black = 0;
+    uint64_t white = 0;
+    int sideToMove = REVERSI_BLACK;
+    int sq = 0;
+    for (const char *c = text; *c; c++) {
+        if (*c == ' ' || *c == '\t' || *c == '\n' || *c == '\r') continue;
+        bool isBlack = *c == 'X' || *c == 'x' || *c == 'B' || *c == 'b' || *c == '*';
+        bool isWhite = *c == 'O' || *c == 'o' || *c == 'W' || *c == 'w';
+        bool isEmpty = *c == '-' || *c == '.';
+        if (sq == BB_SQUARES) {
+            if (!isBlack && !isWhite) return REVERSI_ERROR_POSITION;
+            sideToMove = isBlack ? REVERSI_BLACK : REVERSI_WHITE;
+            sq++;
+            continue;
+        }
+        if (sq > BB_SQUARES || (!isBlack && !isWhite && !isEmpty)) return REVERSI_ERROR_POSITION;
+        if (isBlack) black |= squareBit(sq);
+        if (isWhite) white |= squareBit(sq);
+        sq++;
+    }
+    if (sq < BB_SQUARES) return REVERSI_ERROR_POSITION;
+    return reversiSetBitboards(handle, black, white, sideToMove);
+}
+
+int reversiSetBitboards(ReversiHandle *handle, uint64_t black, uint64_t white, int sideToMove) {
+    if (!handle) return REVERSI_ERROR_ARGUMENT;
+    if (!validPosition(black, white, sideToMove)) return REVERSI_ERROR_POSITION;
+    handle->black = black;
+    handle->white = white;
+    handle->sideToMove = sideToMove;
+    return REVERSI_OK;
+}
+
+int reversiGetPosition(const ReversiHandle *handle, ReversiPosition *position) {
+    if (!handle || !position) return REVERSI_ERROR_ARGUMENT;
+    position->black = handle->black;
+    position->white = handle->white;
+    position->sideToMove = handle->sideToMove;
+    return REVERSI_OK;
+}
+
+uint64_t reversiLegalMoves(const ReversiHandle *handle) {
+    if (!handle) return 0;
+    return handle->sideToMove == REVERSI_BLACK ? getMoves(handle->black, handle->white) : getMoves(handle->white, handle->black);
+}
+
+int reversiPlay(ReversiHandle *handle, int square) {
+    if (!handle) return REVERSI_ERROR_ARGUMENT;
+    uint64_t &P = handle->sideToMove == REVERSI_BLACK ? handle->black : handle->white;
+    uint64_t &O = handle->sideToMove == REVERSI_BLACK ? handle->white : handle->black;
+    if (square == REVERSI_PASS) {
+        if (getMoves(P, O) != 0) return REVERSI_ERROR_ILLEGAL_MOVE;
+    } else if (square < 0 || square >= BB_SQUARES || !playMove(square, P, O)) {
+        return REVERSI_ERROR_ILLEGAL_MOVE;
+    }
+    handle->sideToMove = handle->sideToMove == REVERSI_BLACK ? REVERSI_WHITE : REVERSI_BLACK;
+    return REVERSI_OK;
+}
+
+int reversiSearch(ReversiHandle *handle, const ReversiLimits *limits, ReversiResult *result) {
+    if (!handle || !limits || !result) return REVERSI_ERROR_ARGUMENT;
+    handle->stop.store(false);
+    ReversiPosition position = {handle->black, handle->white, handle->sideToMove};
+    searchPosition(handle, position, *limits, *result);
+    return REVERSI_OK;
+}
+
+int reversiSearchBatch(ReversiHandle *handle, const ReversiPosition *positions, size_t count,
+                       const ReversiLimits *limits, ReversiResult *results, int threads) {
+    if (!handle || !limits || (count > 0 && (!positions || !results))) return REVERSI_ERROR_ARGUMENT;
+    for (size_t i = 0; i < count; i++) {
+        if (!validPosition(positions[i].black, positions[i].white, positions[i].sideToMove)) return REVERSI_ERROR_POSITION;
+    }
+    handle->stop.store(false);
+
+    if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    if ((size_t)threads > count) threads = (int)std::max<size_t>(count, 1);
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            searchPosition(handle, positions[i], *limits, results[i]);
+        }
+    };
+    std::vector<std::thread> pool;
+    try {
+        for (int t = 1; t < threads; t++) pool.emplace_back(worker);
+    } catch (const std::system_error &) {
+        // Fewer workers than asked for; the ones running still drain the batch
+    }
+    worker();
+    for (std::thread &t : pool) t.join();
+    return REVERSI_OK;
+}
+
+void reversiStop(ReversiHandle *handle) {
+    if (handle) handle->stop.store(true);
+}
+
+void reversiClear(ReversiHandle *handle) {
+    if (handle) ttClear(handle->tt);
+}
+
+}
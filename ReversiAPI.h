@@ -0,0 +1,98 @@
+#ifndef REVERSI_API_H
+#define REVERSI_API_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * C interface to the Reversi engine, built as a shared library:
+ *   g++ -O2 -shared -fPIC ReversiAPI.cpp -o libreversi.so -pthread
+ *
+ * Squares are numbered row * 8 + col (A1 = 0, H1 = 7, A8 = 56), the same
+ * as the game. Scores use the game's evaluation (disc difference, corners
+ * and edges) from the point of view of the side to move.
+ *
+ * A handle may be used by one thread at a time; reversiStop is the only
+ * call that may come from another thread. Structs only ever grow at the end.
+ */
+
+#if defined(_WIN32)
+    #define REVERSI_API __declspec(dllexport)
+#else
+    #define REVERSI_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define REVERSI_API_VERSION 1
+
+#define REVERSI_OK 0
+#define REVERSI_ERROR_ARGUMENT (-1)
+#define REVERSI_ERROR_POSITION (-2)
+#define REVERSI_ERROR_ILLEGAL_MOVE (-3)
+
+#define REVERSI_BLACK 1
+#define REVERSI_WHITE 2
+
+#define REVERSI_PASS 64
+#define REVERSI_NO_MOVE (-1)
+
+typedef struct ReversiHandle ReversiHandle;
+
+typedef struct {
+    uint64_t black;
+    uint64_t white;
+    int32_t sideToMove;     /* REVERSI_BLACK or REVERSI_WHITE */
+} ReversiPosition;
+
+typedef struct {
+    int32_t depth;          /* maximum depth in plies; 0 = static evaluation only */
+    int32_t timeMs;         /* per position; 0 = no limit */
+    uint64_t nodeLimit;     /* per position; 0 = no limit */
+} ReversiLimits;
+
+typedef struct {
+    int32_t bestMove;       /* square, REVERSI_PASS, or REVERSI_NO_MOVE when the game is over */
+    int32_t score;
+    int32_t depth;          /* deepest completed iteration */
+    uint64_t nodes;
+} ReversiResult;
+
+REVERSI_API int reversiApiVersion(void);
+
+/* tableBits: log2 of the transposition table size (0 = default, 2^20
+ * slots; at most 2^26 slots of 16 bytes). Returns NULL when out of memory. */
+REVERSI_API ReversiHandle *reversiCreate(int tableBits);
+REVERSI_API void reversiDestroy(ReversiHandle *handle);
+
+/* 64 squares row by row: X, B or * black; O or W white; - or . empty (any
+ * case); whitespace is skipped. An optional 65th character gives the side
+ * to move (default black). */
+REVERSI_API int reversiSetPosition(ReversiHandle *handle, const char *text);
+REVERSI_API int reversiSetBitboards(ReversiHandle *handle, uint64_t black, uint64_t white, int sideToMove);
+REVERSI_API int reversiGetPosition(const ReversiHandle *handle, ReversiPosition *position);
+
+REVERSI_API uint64_t reversiLegalMoves(const ReversiHandle *handle);
+/* Plays square (or REVERSI_PASS when the side to move has no move) */
+REVERSI_API int reversiPlay(ReversiHandle *handle, int square);
+
+REVERSI_API int reversiSearch(ReversiHandle *handle, const ReversiLimits *limits, ReversiResult *result);
+
+/* Evaluates or searches count positions with the same limits, spread over
+ * threads workers (0 = one per core). results[i] belongs to positions[i]. */
+REVERSI_API int reversiSearchBatch(ReversiHandle *handle, const ReversiPosition *positions, size_t count,
+                                   const ReversiLimits *limits, ReversiResult *results, int threads);
+
+/* Makes a running reversiSearch / reversiSearchBatch return early */
+REVERSI_API void reversiStop(ReversiHandle *handle);
+
+/* Empties the transposition table */
+REVERSI_API void reversiClear(ReversiHandle *handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
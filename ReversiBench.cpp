@@ -0,0 +1,589 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ReversiEngine.h"
+#include "Search.h"
+#ifdef __linux__
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+using namespace std;
+
+// Microbenchmarks for the engine primitives over a fixed position corpus.
+//
+// Usage: ReversiBench [--json out.json] [--baseline base.json] [--threshold pct] [--reps n] [--deep]
+// With --baseline, any benchmark whose ns/op grew by more than the threshold
+// (default 10%) is reported and the exit code is 1. --deep adds the 22-empty
+// endgame solves, which take minutes per rep on a single core.
+
+const int CORPUS_SIZE = 200;
+const int SEARCH_POSITIONS = 40;
+const int PRIMITIVE_LOOPS = 200;
+const int BITBOARD_SEARCH_DEPTH = 6;
+const int SOLVE_POSITIONS = 4;
+const int SOLVE_DISCS = 48;         // 16 empties
+const int SOLVE_DEEP_POSITIONS = 2;
+const int SOLVE_DEEP_DISCS = 42;    // 22 empties, deep enough for split points to matter
+const int PROOF_POSITIONS = 4;
+const int PROOF_DISCS = 40;         // 24 empties, inside the proof-number range
+const uint64_t CORPUS_SEED = 0x5EED0F0E11011ULL;
+
+const int COUNTER_COUNT = 4;
+const char* COUNTER_NAMES[COUNTER_COUNT] = {"cycles", "instructions", "branch_misses", "cache_misses"};
+
+struct CorpusPosition {
+    uint64_t black;
+    uint64_t white;
+    int player;
+};
+
+struct BenchResult {
+    string name;
+    double nsPerOp;
+    uint64_t ops;
+    double nodesPerSec;
+    bool hasCounters;
+    double countersPerOp[COUNTER_COUNT];
+};
+
+vector<CorpusPosition> midgame;
+vector<CorpusPosition> endgame;
+vector<CorpusPosition> solveCorpus;
+vector<CorpusPosition> solveDeepCorpus;
+vector<CorpusPosition> proofCorpus;
+volatile long benchSink = 0;
+
+uint64_t benchRandom(uint64_t &state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// Plays corner-preferring random games and keeps positions with the wanted disc count.
+// Only the rules are involved, so the corpus is identical across engine changes.
+void buildCorpus(vector<CorpusPosition> &corpus, int minDiscs, int maxDiscs, uint64_t seed) {
+    uint64_t rng = seed;
+    while ((int)corpus.size() < CORPUS_SIZE) {
+        uint64_t black = squareBit(3 * 8 + 4) | squareBit(4 * 8 + 3);
+        uint64_t white = squareBit(3 * 8 + 3) | squareBit(4 * 8 + 4);
+        int player = BLACK;
+        int target = minDiscs + (int)(benchRandom(rng) % (maxDiscs - minDiscs + 1));
+
+        while (popCount(black | white) < target) {
+            uint64_t &P = (player == BLACK) ? black : white;
+            uint64_t &O = (player == BLACK) ? white : black;
+            uint64_t moves = getMoves(P, O);
+            if (moves == 0) {
+                if (getMoves(O, P) == 0) break;
+                player = (player == BLACK) ? WHITE : BLACK;
+                continue;
+            }
+            if (moves & BB_CORNERS) moves &= BB_CORNERS;
+            int k = (int)(benchRandom(rng) % popCount(moves));
+            while (k--) moves &= moves - 1;
+            playMove(firstSquare(moves), P, O);
+            player = (player == BLACK) ? WHITE : BLACK;
+        }
+
+        uint64_t P = (player == BLACK) ? black : white;
+        uint64_t O = (player == BLACK) ? white : black;
+        if (popCount(black | white) == target && getMoves(P, O) != 0) {
+            corpus.push_back({black, white, player});
+        }
+    }
+}
+
+void loadPosition(const CorpusPosition &pos) {
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            uint64_t bit = squareBit(i * BOARD_SIZE + j);
+            board[i][j] = (pos.black & bit) ? BLACK : ((pos.white & bit) ? WHITE : EMPTY);
+        }
+    }
+    moveCount = popCount(pos.black | pos.white);
+    syncBitboards();
+}
+
+// Random small weights: inference cost does not depend on the values
+void buildBenchNetwork(NNUENetwork &net, uint64_t seed) {
+    uint64_t state = seed;
+    for (int i = 0; i < NNUE_HIDDEN1; i++) {
+        net.featureBias[i] = (int16_t)(benchRandom(state) % 64);
+        for (int f = 0; f < NNUE_INPUTS; f++) net.featureWeights[f][i] = (int16_t)((int)(benchRandom(state) % 41) - 20);
+    }
+    for (int j = 0; j < NNUE_HIDDEN2; j++) {
+        net.hiddenBias[j] = (int32_t)(benchRandom(state) % 2000) - 1000;
+        for (int i = 0; i < NNUE_HIDDEN1; i++) net.hiddenWeights[j][i] = (int8_t)benchRandom(state);
+        net.outputWeights[j] = (int8_t)benchRandom(state);
+    }
+    net.outputBias = 0;
+    net.id = 1;
+}
+
+// ---- Hardware counters (Linux perf events, silently skipped elsewhere) ----
+
+struct PerfCounters {
+    int fds[COUNTER_COUNT];
+    bool available;
+};
+
+PerfCounters perf;
+
+void openCounters() {
+    perf.available = false;
+    #ifdef __linux__
+        const uint64_t configs[COUNTER_COUNT] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                 PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES};
+        for (int i = 0; i < COUNTER_COUNT; i++) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = configs[i];
+            attr.disabled = (i == 0);
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            int group = (i == 0) ? -1 : perf.fds[0];
+            perf.fds[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+            if (perf.fds[i] < 0) {
+                for (int j = 0; j < i; j++) close(perf.fds[j]);
+                return;
+            }
+        }
+        perf.available = true;
+    #endif
+}
+
+void startCounters() {
+    #ifdef __linux__
+        if (!perf.available) return;
+        ioctl(perf.fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(perf.fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    #endif
+}
+
+bool stopCounters(uint64_t values[COUNTER_COUNT]) {
+    #ifdef __linux__
+        if (!perf.available) return false;
+        ioctl(perf.fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        uint64_t buffer[1 + COUNTER_COUNT];
+        if (read(perf.fds[0], buffer, sizeof(buffer)) != (ssize_t)sizeof(buffer)) return false;
+        for (int i = 0; i < COUNTER_COUNT; i++) values[i] = buffer[1 + i];
+        return true;
+    #else
+        (void)values;
+        return false;
+    #endif
+}
+
+// ---- Harness ----
+
+// body() runs the benchmark once and returns the number of operations;
+// nodes is filled in by search benchmarks. The median repetition is kept.
+template <typename Body>
+BenchResult measure(const string &name, int reps, Body body) {
+    vector<BenchResult> runs;
+    for (int r = 0; r < reps; r++) {
+        uint64_t nodes = 0;
+        uint64_t counters[COUNTER_COUNT];
+        startCounters();
+        auto start = chrono::steady_clock::now();
+        uint64_t ops = body(nodes);
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        bool hasCounters = stopCounters(counters);
+
+        BenchResult result;
+        result.name = name;
+        result.ops = ops;
+        result.nsPerOp = ns / ops;
+        result.nodesPerSec = nodes ? nodes / (ns * 1e-9) : 0.0;
+        result.hasCounters = hasCounters;
+        for (int i = 0; i < COUNTER_COUNT; i++) {
+            result.countersPerOp[i] = hasCounters ? (double)counters[i] / ops : 0.0;
+        }
+        runs.push_back(result);
+    }
+    sort(runs.begin(), runs.end(), [](const BenchResult &a, const BenchResult &b) { return a.nsPerOp < b.nsPerOp; });
+    return runs[runs.size() / 2];
+}
+
+// A corpus position as the engine globals hold it, prepared before any clock
+// starts so the primitive benchmarks only pay for a copy
+struct LoadedPosition {
+    int board[BOARD_SIZE][BOARD_SIZE];
+    uint64_t black;
+    uint64_t white;
+    int moveCount;
+    int player;
+    NNUEAccumulator acc;
+};
+
+LoadedPosition preparePosition(const CorpusPosition &pos) {
+    LoadedPosition loaded;
+    loadPosition(pos);
+    memcpy(loaded.board, board, sizeof(board));
+    loaded.black = blackBits;
+    loaded.white = whiteBits;
+    loaded.moveCount = moveCount;
+    loaded.player = pos.player;
+    nnueRefresh(nnueNet, loaded.acc, pos.black, pos.white);
+    return loaded;
+}
+
+void restorePosition(const LoadedPosition &loaded) {
+    memcpy(board, loaded.board, sizeof(board));
+    blackBits = loaded.black;
+    whiteBits = loaded.white;
+    moveCount = loaded.moveCount;
+}
+
+vector<BenchResult> runBenchmarks(int reps, bool deep) {
+    vector<BenchResult> results;
+    vector<CorpusPosition> all = midgame;
+    all.insert(all.end(), endgame.begin(), endgame.end());
+    buildBenchNetwork(nnueNet, CORPUS_SEED);
+    vector<LoadedPosition> loaded;
+    for (const CorpusPosition &pos : all) loaded.push_back(preparePosition(pos));
+
+    results.push_back(measure("isValidMove", reps, [&](uint64_t &) {
+        uint64_t ops = 0;
+        for (const LoadedPosition &pos : loaded) {
+            restorePosition(pos);
+            for (int loop = 0; loop < PRIMITIVE_LOOPS; loop++) {
+                for (int sq = 0; sq < BOARD_SIZE * BOARD_SIZE; sq++) {
+                    benchSink += isValidMove(sq / BOARD_SIZE, sq % BOARD_SIZE, pos.player);
+                }
+            }
+            ops += PRIMITIVE_LOOPS * BOARD_SIZE * BOARD_SIZE;
+        }
+        return ops;
+    }));
+
+    results.push_back(measure("makeMove", reps, [&](uint64_t &) {
+        uint64_t ops = 0;
+        for (const LoadedPosition &pos : loaded) {
+            restorePosition(pos);
+            uint64_t P = (pos.player == BLACK) ? pos.black : pos.white;
+            uint64_t O = (pos.player == BLACK) ? pos.white : pos.black;
+            uint64_t moves = getMoves(P, O);
+            for (int loop = 0; loop < PRIMITIVE_LOOPS; loop++) {
+                for (uint64_t m = moves; m; m &= m - 1) {
+                    int sq = firstSquare(m);
+                    makeMove(sq / BOARD_SIZE, sq % BOARD_SIZE, pos.player);
+                    benchSink += board[sq / BOARD_SIZE][sq % BOARD_SIZE];
+                    // Undo only the squares the move changed, as a search would
+                    for (uint64_t c = (blackBits ^ pos.black) | (whiteBits ^ pos.white); c; c &= c - 1) {
+                        int f = firstSquare(c);
+                        board[f / BOARD_SIZE][f % BOARD_SIZE] = pos.board[f / BOARD_SIZE][f % BOARD_SIZE];
+                    }
+                    moveCount = pos.moveCount;
+                    blackBits = pos.black;
+                    whiteBits = pos.white;
+                    ops++;
+                }
+            }
+        }
+        return ops;
+    }));
+
+    results.push_back(measure("hasValidMoves", reps, [&](uint64_t &) {
+        uint64_t ops = 0;
+        for (const LoadedPosition &pos : loaded) {
+            restorePosition(pos);
+            for (int loop = 0; loop < PRIMITIVE_LOOPS; loop++) {
+                benchSink += hasValidMoves(pos.player);
+                benchSink += hasValidMoves(pos.player == BLACK ? WHITE : BLACK);
+            }
+            ops += 2 * PRIMITIVE_LOOPS;
+        }
+        return ops;
+    }));
+
+    results.push_back(measure("countPieces", reps, [&](uint64_t &) {
+        uint64_t ops = 0;
+        for (const LoadedPosition &pos : loaded) {
+            restorePosition(pos);
+            for (int loop = 0; loop < PRIMITIVE_LOOPS; loop++) {
+                int blackCount, whiteCount;
+                countPieces(blackCount, whiteCount);
+                benchSink += blackCount - whiteCount;
+            }
+            ops += PRIMITIVE_LOOPS;
+        }
+        return ops;
+    }));
+
+    // The four edges as base-3 pattern indexes
+    const uint64_t edgeMasks[4] = {0x00000000000000FFULL, 0xFF00000000000000ULL, 0x0101010101010101ULL, 0x8080808080808080ULL};
+    results.push_back(measure("patternIndex", reps, [&](uint64_t &) {
+        uint64_t ops = 0;
+        for (const CorpusPosition &pos : all) {
+            for (int loop = 0; loop < PRIMITIVE_LOOPS; loop++) {
+                for (int e = 0; e < 4; e++) {
+                    benchSink += engineKernels.patternIndex(pos.black, pos.white, edgeMasks[e]);
+                }
+            }
+            ops += 4 * PRIMITIVE_LOOPS;
+        }
+        return ops;
+    }));
+
+    results.push_back(measure("evaluateBoard", reps, [&](uint64_t &) {
+        uint64_t ops = 0;
+        for (const LoadedPosition &pos : loaded) {
+            restorePosition(pos);
+            for (int loop = 0; loop < PRIMITIVE_LOOPS; loop++) {
+                benchSink += evaluateBoard(pos.player);
+            }
+            ops += PRIMITIVE_LOOPS;
+        }
+        return ops;
+    }));
+
+    useNNUE = true;
+    results.push_back(measure("evaluateBoard_nnue", reps, [&](uint64_t &) {
+        uint64_t ops = 0;
+        for (const LoadedPosition &pos : loaded) {
+            restorePosition(pos);
+            nnueAcc = pos.acc;
+            for (int loop = 0; loop < PRIMITIVE_LOOPS; loop++) {
+                benchSink += evaluateBoard(pos.player);
+            }
+            ops += PRIMITIVE_LOOPS;
+        }
+        return ops;
+    }));
+    useNNUE = false;
+
+    // Full fixed-depth minimax searches, as getAIMove runs them once the
+    // book, the endgame solvers, MCTS and the cache have nothing to offer
+    auto searchCorpus = [&](const vector<CorpusPosition> &corpus) {
+        return [&corpus](uint64_t &nodes) {
+            uint64_t startNodes = searchNodes;
+            for (int i = 0; i < SEARCH_POSITIONS; i++) {
+                loadPosition(corpus[i]);
+                int row, col, score;
+                minimaxRoot(row, col, corpus[i].player, score);
+                benchSink += row * BOARD_SIZE + col + score;
+            }
+            nodes = searchNodes - startNodes;
+            return (uint64_t)SEARCH_POSITIONS;
+        };
+    };
+    results.push_back(measure("minimax_d4_midgame", reps, searchCorpus(midgame)));
+    results.push_back(measure("minimax_d4_endgame", reps, searchCorpus(endgame)));
+    useNNUE = true;
+    results.push_back(measure("minimax_d4_midgame_nnue", reps, searchCorpus(midgame)));
+    useNNUE = false;
+
+    TranspositionTable tt;
+    ttInit(tt, 18);
+    results.push_back(measure("bitboard_search_d6_midgame", reps, [&](uint64_t &nodes) {
+        SearchContext ctx;
+        ctx.tt = &tt;
+        ctx.edgeWeight = EDGE_WEIGHT;
+        for (int i = 0; i < SEARCH_POSITIONS; i++) {
+            ttClear(tt);
+            uint64_t P = (midgame[i].player == BLACK) ? midgame[i].black : midgame[i].white;
+            uint64_t O = (midgame[i].player == BLACK) ? midgame[i].white : midgame[i].black;
+            benchSink += searchNegamax(ctx, P, O, BITBOARD_SEARCH_DEPTH, -SEARCH_INFINITY, SEARCH_INFINITY, true);
+        }
+        nodes = ctx.nodes;
+        return (uint64_t)SEARCH_POSITIONS;
+    }));
+
+    // Exact endgame solves, on one thread and on every core
+    EndgameSolver solver;
+    auto solveBench = [&](const vector<CorpusPosition> &corpus, int count, int threads) {
+        return [&solver, &corpus, count, threads](uint64_t &nodes) {
+            solver.threads = threads;
+            for (int i = 0; i < count; i++) {
+                ttClear(solver.tt);
+                uint64_t P = (corpus[i].player == BLACK) ? corpus[i].black : corpus[i].white;
+                uint64_t O = (corpus[i].player == BLACK) ? corpus[i].white : corpus[i].black;
+                SolverResult result = solveEndgame(solver, P, O);
+                benchSink += result.score;
+                nodes += result.nodes;
+            }
+            return (uint64_t)count;
+        };
+    };
+    int allThreads = (int)max(1u, thread::hardware_concurrency());
+    results.push_back(measure("solve_endgame_16e_1t", reps, solveBench(solveCorpus, SOLVE_POSITIONS, 1)));
+    results.push_back(measure("solve_endgame_16e_mt", reps, solveBench(solveCorpus, SOLVE_POSITIONS, allThreads)));
+    // Minutes per rep on one core, so only with --deep
+    if (deep) {
+        results.push_back(measure("solve_endgame_22e_1t", reps, solveBench(solveDeepCorpus, SOLVE_DEEP_POSITIONS, 1)));
+        results.push_back(measure("solve_endgame_22e_mt", reps, solveBench(solveDeepCorpus, SOLVE_DEEP_POSITIONS, allThreads)));
+    }
+
+    // Win/draw/loss proofs with the engine's node budget, as getAIMove tries them
+    ProofSearch proof;
+    results.push_back(measure("pn_solve_24e", reps, [&](uint64_t &nodes) {
+        proof.nodeLimit = PN_ENGINE_NODE_LIMIT;
+        for (int i = 0; i < PROOF_POSITIONS; i++) {
+            uint64_t P = (proofCorpus[i].player == BLACK) ? proofCorpus[i].black : proofCorpus[i].white;
+            uint64_t O = (proofCorpus[i].player == BLACK) ? proofCorpus[i].white : proofCorpus[i].black;
+            int move;
+            benchSink += pnSolve(proof, P, O, move) + move;
+            nodes += proof.nodes;
+        }
+        return (uint64_t)PROOF_POSITIONS;
+    }));
+
+    results.push_back(measure("mcts_playout", reps, [&](uint64_t &) {
+        uint64_t rng = CORPUS_SEED;
+        uint64_t ops = 0;
+        for (const CorpusPosition &pos : midgame) {
+            uint64_t P = (pos.player == BLACK) ? pos.black : pos.white;
+            uint64_t O = (pos.player == BLACK) ? pos.white : pos.black;
+            for (int loop = 0; loop < PRIMITIVE_LOOPS; loop++) {
+                benchSink += mctsPlayout(P, O, rng);
+            }
+            ops += PRIMITIVE_LOOPS;
+        }
+        return ops;
+    }));
+
+    return results;
+}
+
+// ---- Reporting ----
+
+void printResults(const vector<BenchResult> &results) {
+    printf("%-28s %14s %16s", "benchmark", "ns/op", "nodes/s");
+    if (perf.available) printf(" %10s %8s %12s %12s", "cycles/op", "IPC", "br-miss/op", "cache-miss/op");
+    printf("\n");
+    for (const BenchResult &r : results) {
+        printf("%-28s %14.1f %16.0f", r.name.c_str(), r.nsPerOp, r.nodesPerSec);
+        if (r.hasCounters) {
+            double ipc = r.countersPerOp[0] > 0 ? r.countersPerOp[1] / r.countersPerOp[0] : 0.0;
+            printf(" %10.1f %8.2f %12.3f %12.3f", r.countersPerOp[0], ipc, r.countersPerOp[2], r.countersPerOp[3]);
+        }
+        printf("\n");
+    }
+    if (!perf.available) printf("(hardware counters unavailable)\n");
+}
+
+bool writeJson(const vector<BenchResult> &results, const string &path) {
+    ofstream out(path);
+    if (!out) return false;
+    out << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"ns_per_op\": " << r.nsPerOp
+            << ", \"ops\": " << r.ops << ", \"nodes_per_sec\": " << r.nodesPerSec;
+        if (r.hasCounters) {
+            for (int c = 0; c < COUNTER_COUNT; c++) {
+                out << ", \"" << COUNTER_NAMES[c] << "_per_op\": " << r.countersPerOp[c];
+            }
+        }
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return true;
+}
+
+// Reads name -> ns_per_op pairs back from a file written by writeJson
+bool readBaseline(const string &path, vector<pair<string, double>> &baseline) {
+    ifstream in(path);
+    if (!in) return false;
+    stringstream buffer;
+    buffer << in.rdbuf();
+    string text = buffer.str();
+
+    size_t pos = 0;
+    while ((pos = text.find("\"name\": \"", pos)) != string::npos) {
+        pos += 9;
+        size_t end = text.find('"', pos);
+        size_t value = text.find("\"ns_per_op\": ", end);
+        if (end == string::npos || value == string::npos) break;
+        baseline.push_back({text.substr(pos, end - pos), atof(text.c_str() + value + 13)});
+        pos = value;
+    }
+    return true;
+}
+
+int compareBaseline(const vector<BenchResult> &results, const vector<pair<string, double>> &baseline, double threshold) {
+    int regressions = 0;
+    printf("\n%-28s %14s %14s %9s\n", "benchmark", "baseline", "current", "change");
+    for (const BenchResult &r : results) {
+        for (const auto &base : baseline) {
+            if (base.first != r.name || base.second <= 0) continue;
+            double change = (r.nsPerOp / base.second - 1.0) * 100.0;
+            bool regressed = change > threshold;
+            printf("%-28s %14.1f %14.1f %+8.1f%%%s\n", r.name.c_str(), base.second, r.nsPerOp, change,
+                   regressed ? "  REGRESSION" : "");
+            regressions += regressed;
+        }
+    }
+    return regressions;
+}
+
+int main(int argc, char* argv[]) {
+    string jsonPath;
+    string baselinePath;
+    double threshold = 10.0;
+    int reps = 5;
+    bool deep = false;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (arg == "--baseline" && i + 1 < argc) {
+            baselinePath = argv[++i];
+        } else if (arg == "--threshold" && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else if (arg == "--reps" && i + 1 < argc) {
+            reps = max(1, atoi(argv[++i]));
+        } else if (arg == "--deep") {
+            deep = true;
+        } else {
+            cout << "Usage: " << argv[0] << " [--json out.json] [--baseline base.json] [--threshold pct] [--reps n] [--deep]\n";
+            return 2;
+        }
+    }
+
+    buildCorpus(midgame, 20, 40, CORPUS_SEED);
+    buildCorpus(endgame, 50, 58, CORPUS_SEED + 1);
+    buildCorpus(solveCorpus, SOLVE_DISCS, SOLVE_DISCS, CORPUS_SEED + 2);
+    buildCorpus(proofCorpus, PROOF_DISCS, PROOF_DISCS, CORPUS_SEED + 3);
+    buildCorpus(solveDeepCorpus, SOLVE_DEEP_DISCS, SOLVE_DEEP_DISCS, CORPUS_SEED + 4);
+    openCounters();
+
+    printf("Engine kernels: %s\n\n", engineKernels.name);
+    vector<BenchResult> results = runBenchmarks(reps, deep);
+    printResults(results);
+
+    if (!jsonPath.empty() && !writeJson(results, jsonPath)) {
+        cout << "Cannot write " << jsonPath << "\n";
+        return 2;
+    }
+
+    if (!baselinePath.empty()) {
+        vector<pair<string, double>> baseline;
+        if (!readBaseline(baselinePath, baseline)) {
+            cout << "Cannot read baseline " << baselinePath << "\n";
+            return 2;
+        }
+        int regressions = compareBaseline(results, baseline, threshold);
+        if (regressions > 0) {
+            printf("\n%d benchmark(s) regressed by more than %.1f%%\n", regressions, threshold);
+            return 1;
+        }
+    }
+    return 0;
+}
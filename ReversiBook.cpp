@@ -0,0 +1,423 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "Bitboard.h"
+#include "OpeningBook.h"
+#include "Search.h"
+#include "Symmetry.h"
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+using namespace std;
+
+// Opening-book builder using drop-out expansion.
+//
+// Usage: ReversiBook --out book.bin [--positions n] [--depth d] [--threads n]
+//                    [--max-ply n] [--dropout cost] [--save-minutes m]
+//
+// Every book position is searched with all moves scored exactly. The next
+// positions to add are the cheapest unexplored moves, where a path costs
+// DROPOUT per ply plus how much worse than best each move on it is
+// (negamax values backed up through the book). Each round adds one batch
+// of positions, searched in parallel with a shared transposition table.
+// Every searched position is appended to <out>.journal, so an interrupted
+// build (Ctrl+C or a crash) resumes where it stopped; the compact book
+// is rewritten every few minutes and at the end.
+
+const int DEFAULT_DEPTH = 10;
+const int DEFAULT_POSITIONS = 10000;
+const int DEFAULT_MAX_PLY = 24;
+const int DEFAULT_DROPOUT = 4;
+const int DEFAULT_SAVE_MINUTES = 10;
+// Every book position is searched as its own root, and a child's negated
+// value is compared with its parent's estimate of the move. The edge term
+// only rewards the root player's edges, so the book uses discs and
+// corners alone, which score both sides alike.
+const int EDGE_WEIGHT = 0;
+const uint32_t JOURNAL_VERSION = 2;     // 2: zero-sum evaluation
+const int BATCH_PER_THREAD = 2;
+const uint64_t START_BLACK = 0x0000000810000000ULL;
+const uint64_t START_WHITE = 0x0000001008000000ULL;
+
+struct BookMove {
+    uint8_t move;       // BB_PASS for a forced pass
+    int16_t estimate;   // search score of the move for the side to move
+};
+
+struct BuildNode {
+    uint64_t P;         // canonical, side to move first
+    uint64_t O;
+    vector<BookMove> moves;
+    int terminalScore;  // used when moves is empty (game over)
+    int value;          // negamax value, refreshed by backUpValues
+};
+
+struct Candidate {
+    int cost;
+    uint64_t P;
+    uint64_t O;
+};
+
+unordered_map<uint64_t, BuildNode> nodes;
+volatile sig_atomic_t interrupted = 0;
+
+void onInterrupt(int) {
+    interrupted = 1;
+}
+
+// Canonical position after move (P, O swap: the opponent is to move)
+void childPosition(const BuildNode &node, int move, uint64_t &cp, uint64_t &co) {
+    uint64_t P = node.P;
+    uint64_t O = node.O;
+    if (move != BB_PASS) playMove(move, P, O);
+    canonicalPosition(O, P, cp, co);
+}
+
+BuildNode *findNode(uint64_t P, uint64_t O) {
+    auto it = nodes.find(hashPosition(P, O));
+    return it != nodes.end() && it->second.P == P && it->second.O == O ? &it->second : nullptr;
+}
+
+// ---- Searching new positions ----
+
+// Each move is scored as the mean of its depth and depth - 1 searches. A
+// child's value comes from one ply deeper than its parent's estimate of the
+// move, and the mean cancels the odd/even swing between the two.
+BuildNode searchPosition(SearchContext &ctx, uint64_t P, uint64_t O, int depth) {
+    BuildNode node;
+    node.P = P;
+    node.O = O;
+    node.terminalScore = 0;
+    node.value = 0;
+
+    if (getMoves(P, O) == 0) {
+        if (getMoves(O, P) == 0) {
+            node.terminalScore = evaluatePosition(P, O, EDGE_WEIGHT);
+        } else {
+            int score = -searchNegamax(ctx, O, P, depth - 1, -SEARCH_INFINITY, SEARCH_INFINITY, false);
+            if (depth > 2) score = (score - searchNegamax(ctx, O, P, depth - 2, -SEARCH_INFINITY, SEARCH_INFINITY, false)) / 2;
+            node.moves.push_back({(uint8_t)BB_PASS, (int16_t)score});
+        }
+        return node;
+    }
+
+    MoveScore shallow[BB_SQUARES];
+    int shallowScore[BB_SQUARES];
+    if (depth > 1) {
+        int count = analyseRootMoves(ctx, P, O, depth - 1, 0, shallow);
+        for (int i = 0; i < count; i++) shallowScore[shallow[i].move] = shallow[i].score;
+    }
+    MoveScore scores[BB_SQUARES];
+    int count = analyseRootMoves(ctx, P, O, depth, 0, scores);
+    for (int i = 0; i < count; i++) {
+        int score = scores[i].score;
+        if (depth > 1) score = (score + shallowScore[scores[i].move]) / 2;
+        node.moves.push_back({(uint8_t)scores[i].move, (int16_t)score});
+    }
+    return node;
+}
+
+vector<BuildNode> searchBatch(TranspositionTable &tt, const vector<Candidate> &batch, int depth, int threads) {
+    vector<BuildNode> results(batch.size());
+    atomic<size_t> next{0};
+    auto worker = [&]() {
+        SearchContext ctx;
+        ctx.tt = &tt;
+        ctx.edgeWeight = EDGE_WEIGHT;
+        for (size_t i = next.fetch_add(1); i < batch.size(); i = next.fetch_add(1)) {
+            results[i] = searchPosition(ctx, batch[i].P, batch[i].O, depth);
+        }
+    };
+    vector<thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(worker);
+    worker();
+    for (thread &t : pool) t.join();
+    return results;
+}
+
+// ---- Negamax back-up and drop-out selection ----
+
+int moveValue(const BuildNode &node, const BookMove &m) {
+    uint64_t cp, co;
+    childPosition(node, m.move, cp, co);
+    const BuildNode *child = findNode(cp, co);
+    return child ? -child->value : m.estimate;
+}
+
+// Children always have more discs (or the same discs after a pass), so
+// repeating passes from the fullest positions down settles every value.
+void backUpValues() {
+    vector<BuildNode *> order;
+    order.reserve(nodes.size());
+    for (auto &entry : nodes) order.push_back(&entry.second);
+    sort(order.begin(), order.end(), [](const BuildNode *a, const BuildNode *b) {
+        return popCount(a->P | a->O) > popCount(b->P | b->O);
+    });
+    for (int pass = 0; pass < 2; pass++) {
+        for (BuildNode *node : order) {
+            if (node->moves.empty()) {
+                node->value = node->terminalScore;
+                continue;
+            }
+            int best = -SEARCH_INFINITY;
+            for (const BookMove &m : node->moves) best = max(best, moveValue(*node, m));
+            node->value = best;
+        }
+    }
+}
+
+// The batchSize cheapest positions one move outside the book
+vector<Candidate> selectCandidates(size_t batchSize, int dropout, int maxPly) {
+    uint64_t rootP, rootO;
+    canonicalPosition(START_BLACK, START_WHITE, rootP, rootO);
+
+    typedef pair<int, uint64_t> QueueItem;
+    priority_queue<QueueItem, vector<QueueItem>, greater<QueueItem>> queue;
+    unordered_set<uint64_t> settled;
+    unordered_map<uint64_t, Candidate> candidates;
+    vector<int> costs;
+    queue.push({0, hashPosition(rootP, rootO)});
+
+    while (!queue.empty()) {
+        QueueItem item = queue.top();
+        queue.pop();
+        if (candidates.size() >= batchSize) {
+            // Move costs are never negative: nothing cheaper can turn up now
+            nth_element(costs.begin(), costs.begin() + (batchSize - 1), costs.end());
+            if (item.first >= costs[batchSize - 1]) break;
+        }
+        if (!settled.insert(item.second).second) continue;
+        const BuildNode &node = nodes[item.second];
+
+        for (const BookMove &m : node.moves) {
+            uint64_t cp, co;
+            childPosition(node, m.move, cp, co);
+            int cost = item.first + dropout + (node.value - moveValue(node, m));
+            uint64_t key = hashPosition(cp, co);
+            if (findNode(cp, co)) {
+                if (!settled.count(key)) queue.push({cost, key});
+            } else if (popCount(cp | co) - 4 <= maxPly) {
+                auto it = candidates.find(key);
+                if (it == candidates.end()) {
+                    candidates[key] = {cost, cp, co};
+                    costs.push_back(cost);
+                } else if (cost < it->second.cost) {
+                    it->second.cost = cost;
+                }
+            }
+        }
+    }
+
+    vector<Candidate> batch;
+    for (auto &entry : candidates) batch.push_back(entry.second);
+    sort(batch.begin(), batch.end(), [](const Candidate &a, const Candidate &b) { return a.cost < b.cost; });
+    if (batch.size() > batchSize) batch.resize(batchSize);
+    return batch;
+}
+
+// ---- Journal (checkpoint) ----
+// "RVBJ", version, depth; then per position: P, O, move count, (move, estimate)...
+
+bool writeJournalHeader(FILE *file, uint32_t depth) {
+    uint32_t fields[2] = {JOURNAL_VERSION, depth};
+    return fwrite("RVBJ", 1, 4, file) == 4 && fwrite(fields, sizeof(fields), 1, file) == 1;
+}
+
+bool appendJournal(FILE *file, const BuildNode &node) {
+    uint8_t count = (uint8_t)node.moves.size();
+    int16_t terminal = (int16_t)node.terminalScore;
+    bool ok = fwrite(&node.P, 8, 1, file) == 1 && fwrite(&node.O, 8, 1, file) == 1
+           && fwrite(&count, 1, 1, file) == 1 && fwrite(&terminal, 2, 1, file) == 1;
+    for (const BookMove &m : node.moves) {
+        ok = ok && fwrite(&m.move, 1, 1, file) == 1 && fwrite(&m.estimate, 2, 1, file) == 1;
+    }
+    return ok;
+}
+
+// Loads every complete, well-formed record; returns false if the journal
+// belongs to another depth. validEnd is the offset just past the last good
+// record, where a crash may have left a torn one.
+bool loadJournal(const string &path, uint32_t depth, long &validEnd) {
+    validEnd = 0;
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) return true;
+    char magic[4];
+    uint32_t fields[2];
+    if (fread(magic, 1, 4, file) != 4 || memcmp(magic, "RVBJ", 4) != 0 || fread(fields, sizeof(fields), 1, file) != 1
+        || fields[0] != JOURNAL_VERSION || fields[1] != depth) {
+        fclose(file);
+        return false;
+    }
+    validEnd = ftell(file);
+    while (true) {
+        BuildNode node;
+        uint8_t count;
+        int16_t terminal;
+        if (fread(&node.P, 8, 1, file) != 1 || fread(&node.O, 8, 1, file) != 1
+            || fread(&count, 1, 1, file) != 1 || fread(&terminal, 2, 1, file) != 1
+            || (node.P & node.O) != 0 || count > BB_SQUARES) {
+            break;
+        }
+        node.terminalScore = terminal;
+        node.value = 0;
+        bool complete = true;
+        for (int i = 0; i < count && complete; i++) {
+            BookMove m;
+            complete = fread(&m.move, 1, 1, file) == 1 && fread(&m.estimate, 2, 1, file) == 1 && m.move <= BB_PASS;
+            node.moves.push_back(m);
+        }
+        if (!complete) break;
+        nodes[hashPosition(node.P, node.O)] = node;
+        validEnd = ftell(file);
+    }
+    fclose(file);
+    return true;
+}
+
+bool saveBook(const string &path, uint32_t depth) {
+    OpeningBook book;
+    book.depth = depth;
+    for (const auto &entry : nodes) {
+        const BuildNode &node = entry.second;
+        BookEntry e;
+        e.P = node.P;
+        e.O = node.O;
+        e.score = (int16_t)node.value;
+        e.bestMove = (uint8_t)BB_PASS;
+        e.flags = 0;
+        int best = -SEARCH_INFINITY;
+        for (const BookMove &m : node.moves) {
+            int v = moveValue(node, m);
+            if (v > best) {
+                best = v;
+                e.bestMove = m.move;
+            }
+        }
+        book.entries.push_back(e);
+    }
+    return bookSave(book, path);
+}
+
+int main(int argc, char* argv[]) {
+    string outPath;
+    int positions = DEFAULT_POSITIONS;
+    int depth = DEFAULT_DEPTH;
+    int threads = (int)max(1u, thread::hardware_concurrency());
+    int maxPly = DEFAULT_MAX_PLY;
+    int dropout = DEFAULT_DROPOUT;
+    int saveMinutes = DEFAULT_SAVE_MINUTES;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (arg == "--positions" && i + 1 < argc) {
+            positions = atoi(argv[++i]);
+        } else if (arg == "--depth" && i + 1 < argc) {
+            depth = max(1, atoi(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = max(1, atoi(argv[++i]));
+        } else if (arg == "--max-ply" && i + 1 < argc) {
+            maxPly = max(1, atoi(argv[++i]));
+        } else if (arg == "--dropout" && i + 1 < argc) {
+            dropout = max(0, atoi(argv[++i]));
+        } else if (arg == "--save-minutes" && i + 1 < argc) {
+            saveMinutes = max(1, atoi(argv[++i]));
+        } else {
+            outPath.clear();
+            break;
+        }
+    }
+    if (outPath.empty()) {
+        cout << "Usage: " << argv[0] << " --out book.bin [--positions n] [--depth d] [--threads n]"
+             << " [--max-ply n] [--dropout cost] [--save-minutes m]\n";
+        return 2;
+    }
+
+    string journalPath = outPath + ".journal";
+    long journalEnd;
+    if (!loadJournal(journalPath, depth, journalEnd)) {
+        cout << journalPath << " was built with another depth or version; move it away to start over\n";
+        return 2;
+    }
+    bool fresh = nodes.empty();
+    FILE *journal = fopen(journalPath.c_str(), fresh ? "wb" : "ab");
+    // Cut off a record torn by a crash, so new records start on a record boundary
+    bool truncated = fresh;
+    #ifdef _WIN32
+        if (!fresh && journal) truncated = _chsize(_fileno(journal), journalEnd) == 0;
+    #else
+        if (!fresh && journal) truncated = ftruncate(fileno(journal), journalEnd) == 0;
+    #endif
+    if (!journal || !truncated || (fresh && !writeJournalHeader(journal, depth))) {
+        cout << "Cannot write " << journalPath << "\n";
+        return 2;
+    }
+    if (!fresh) printf("Resuming with %zu positions from %s\n", nodes.size(), journalPath.c_str());
+
+    signal(SIGINT, onInterrupt);
+    TranspositionTable tt;
+    ttInit(tt, 22);
+
+    uint64_t rootP, rootO;
+    canonicalPosition(START_BLACK, START_WHITE, rootP, rootO);
+    if (!findNode(rootP, rootO)) {
+        BuildNode node = searchBatch(tt, {{0, rootP, rootO}}, depth, 1)[0];
+        nodes[hashPosition(node.P, node.O)] = node;
+        appendJournal(journal, node);
+    }
+    backUpValues();
+    const BuildNode *root = findNode(rootP, rootO);
+
+    auto start = chrono::steady_clock::now();
+    auto lastSave = start;
+    size_t added = 0;
+    while (!interrupted && nodes.size() < (size_t)positions) {
+        size_t batchSize = min((size_t)threads * BATCH_PER_THREAD, (size_t)positions - nodes.size());
+        vector<Candidate> batch = selectCandidates(batchSize, dropout, maxPly);
+        if (batch.empty()) {
+            printf("Nothing left to expand within %d plies\n", maxPly);
+            break;
+        }
+
+        vector<BuildNode> results = searchBatch(tt, batch, depth, threads);
+        for (const BuildNode &node : results) {
+            nodes[hashPosition(node.P, node.O)] = node;
+            appendJournal(journal, node);
+        }
+        fflush(journal);
+        backUpValues();
+        added += results.size();
+
+        double hours = chrono::duration<double>(chrono::steady_clock::now() - start).count() / 3600.0;
+        printf("\r%zu positions, root value %d, %.0f positions/hour   ", nodes.size(), root->value, added / hours);
+        fflush(stdout);
+
+        if (chrono::steady_clock::now() - lastSave > chrono::minutes(saveMinutes)) {
+            saveBook(outPath, depth);
+            lastSave = chrono::steady_clock::now();
+        }
+    }
+    printf("\n");
+    fclose(journal);
+
+    if (!saveBook(outPath, depth)) {
+        cout << "Cannot write " << outPath << "\n";
+        return 2;
+    }
+    printf("Wrote %zu positions to %s\n", nodes.size(), outPath.c_str());
+    return 0;
+}
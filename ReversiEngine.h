@@ -0,0 +1,411 @@
+#ifndef REVERSI_ENGINE_H
+#define REVERSI_ENGINE_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include "SearchCache.h"
+#include "MCTS.h"
+#include "ProofNumber.h"
+#include "NNUE.h"
+#include "CpuDispatch.h"
+#include "OpeningBook.h"
+#include "EndgameSolver.h"
+
+// Rules and AI of the console game, shared by Reversi.cpp and ReversiBench.cpp.
+// The board lives in globals, exactly as it always has; blackBits/whiteBits
+// mirror it so the rules can run on the CPU-dispatched bitboard kernels.
+// Code that writes board directly must call syncBitboards afterwards.
+
+const int BOARD_SIZE = 8;
+const int EMPTY = 0;
+const int BLACK = 1;
+const int WHITE = 2;
+const int MAX_DEPTH = 4;
+const int MCTS_TIME_MS = 1000;
+const int EDGE_WEIGHT = 5;
+const int SOLVE_EMPTIES = 16;       // exact endgame solve from here on
+const uint32_t EVAL_ID = 1; // bump when evaluateBoard changes
+
+inline int board[BOARD_SIZE][BOARD_SIZE];
+inline int moveCount = 0;
+inline uint64_t blackBits = 0;
+inline uint64_t whiteBits = 0;
+inline uint64_t searchNodes = 0;
+inline SearchCache searchCache;
+inline MCTSTree mctsTree;
+inline bool useMCTS = false;
+inline ProofSearch proofSearch;
+inline EndgameSolver endgameSolver;
+inline NNUENetwork nnueNet;
+inline NNUEAccumulator nnueAcc;     // follows board during a search when useNNUE is set
+inline bool useNNUE = false;
+inline OpeningBook openingBook;
+
+// Progress of getAIMove, for front-ends that run it on a background thread.
+// Setting stop makes getAIMove return its best move so far; the caller clears it.
+const int AI_PHASE_IDLE = 0;
+const int AI_PHASE_BOOK = 1;
+const int AI_PHASE_PROOF = 2;
+const int AI_PHASE_MCTS = 3;
+const int AI_PHASE_MINIMAX = 4;
+
+struct AIStatus {
+    std::atomic<bool> stop{false};
+    std::atomic<int> phase{AI_PHASE_IDLE};
+    std::atomic<int> depth{0};
+    std::atomic<int> movesSearched{0};
+    std::atomic<int> movesTotal{0};
+    std::atomic<int> bestMove{-1};
+    std::atomic<int> bestScore{0};
+    std::atomic<uint64_t> nodes{0};
+};
+inline AIStatus aiStatus;
+
+inline void syncBitboards() {
+    boardToBitboards(board, BLACK, blackBits, whiteBits);
+}
+
+inline void initBoard() {
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            board[i][j] = EMPTY;
+        }
+    }
+    board[3][3] = WHITE;
+    board[3][4] = BLACK;
+    board[4][3] = BLACK;
+    board[4][4] = WHITE;
+    moveCount = 4;
+    syncBitboards();
+}
+
+inline bool isInBounds(int row, int col) {
+    return row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE;
+}
+
+inline bool isValidMove(int row, int col, int player) {
+    if (!isInBounds(row, col) || board[row][col] != EMPTY) {
+        return false;
+    }
+    
+    uint64_t P = (player == BLACK) ? blackBits : whiteBits;
+    uint64_t O = (player == BLACK) ? whiteBits : blackBits;
+    return engineKernels.flips(row * BOARD_SIZE + col, P, O) != 0;
+}
+
+inline void makeMove(int row, int col, int player) {
+    int sq = row * BOARD_SIZE + col;
+    uint64_t &P = (player == BLACK) ? blackBits : whiteBits;
+    uint64_t &O = (player == BLACK) ? whiteBits : blackBits;
+    uint64_t flips = engineKernels.flips(sq, P, O);
+    int colour = (player == BLACK) ? 0 : 1;
+    
+    board[row][col] = player;
+    moveCount++;
+    P |= flips | squareBit(sq);
+    O &= ~flips;
+    if (useNNUE) nnuePlace(nnueNet, nnueAcc, sq, colour);
+    
+    for (; flips; flips &= flips - 1) {
+        int f = firstSquare(flips);
+        board[f / BOARD_SIZE][f % BOARD_SIZE] = player;
+        if (useNNUE) nnueFlip(nnueNet, nnueAcc, f, colour);
+    }
+}
+
+inline bool hasValidMoves(int player) {
+    uint64_t P = (player == BLACK) ? blackBits : whiteBits;
+    uint64_t O = (player == BLACK) ? whiteBits : blackBits;
+    return engineKernels.moves(P, O) != 0;
+}
+
+inline void countPieces(int &blackCount, int &whiteCount) {
+    blackCount = engineKernels.discCount(blackBits);
+    whiteCount = engineKernels.discCount(whiteBits);
+}
+
+inline int evaluateBoard(int player) {
+    if (useNNUE) {
+        return nnueEvaluate(nnueNet, nnueAcc, player == BLACK ? 0 : 1);
+    }
+    
+    int blackCount, whiteCount;
+    countPieces(blackCount, whiteCount);
+    
+    int cornerWeight = 25;
+    int edgeWeight = EDGE_WEIGHT;
+    int score = 0;
+    
+    if (player == BLACK) {
+        score = blackCount - whiteCount;
+    } else {
+        score = whiteCount - blackCount;
+    }
+    
+    int corners[4][2] = {{0,0},{0,7},{7,0},{7,7}};
+    for (int i = 0; i < 4; i++) {
+        int r = corners[i][0];
+        int c = corners[i][1];
+        if (board[r][c] == player) {
+            score += cornerWeight;
+        } else if (board[r][c] != EMPTY) {
+            score -= cornerWeight;
+        }
+    }
+    
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        if (board[0][i] == player || board[7][i] == player || 
+            board[i][0] == player || board[i][7] == player) {
+            score += edgeWeight;
+        }
+    }
+    
+    return score;
+}
+
+inline int minimax(int depth, bool isMaximizing, int player, int alpha, int beta) {
+    searchNodes++;
+    if (depth == 0 || moveCount == BOARD_SIZE * BOARD_SIZE) {
+        return evaluateBoard(player);
+    }
+    
+    int opponent = (player == BLACK) ? WHITE : BLACK;
+    int currentPlayer = isMaximizing ? player : opponent;
+    
+    if (!hasValidMoves(currentPlayer)) {
+        if (!hasValidMoves(opponent)) {
+            return evaluateBoard(player);
+        }
+        return minimax(depth - 1, !isMaximizing, player, alpha, beta);
+    }
+    
+    if (isMaximizing) {
+        int maxEval = -100000;
+        for (int i = 0; i < BOARD_SIZE; i++) {
+            for (int j = 0; j < BOARD_SIZE; j++) {
+                if (isValidMove(i, j, currentPlayer)) {
+                    int tempBoard[BOARD_SIZE][BOARD_SIZE];
+                    int tempMoveCount = moveCount;
+                    uint64_t tempBlack = blackBits;
+                    uint64_t tempWhite = whiteBits;
+                    NNUEAccumulator tempAcc;
+                    if (useNNUE) tempAcc = nnueAcc;
+                    for (int x = 0; x < BOARD_SIZE; x++) {
+                        for (int y = 0; y < BOARD_SIZE; y++) {
+                            tempBoard[x][y] = board[x][y];
+                        }
+                    }
+                    
+                    makeMove(i, j, currentPlayer);
+                    int eval = minimax(depth - 1, false, player, alpha, beta);
+                    
+                    for (int x = 0; x < BOARD_SIZE; x++) {
+                        for (int y = 0; y < BOARD_SIZE; y++) {
+                            board[x][y] = tempBoard[x][y];
+                        }
+                    }
+                    moveCount = tempMoveCount;
+                    blackBits = tempBlack;
+                    whiteBits = tempWhite;
+                    if (useNNUE) nnueAcc = tempAcc;
+                    
+                    maxEval = (eval > maxEval) ? eval : maxEval;
+                    alpha = (alpha > eval) ? alpha : eval;
+                    if (beta <= alpha) break;
+                }
+            }
+            if (beta <= alpha) break;
+        }
+        return maxEval;
+    } else {
+        int minEval = 100000;
+        for (int i = 0; i < BOARD_SIZE; i++) {
+            for (int j = 0; j < BOARD_SIZE; j++) {
+                if (isValidMove(i, j, currentPlayer)) {
+                    int tempBoard[BOARD_SIZE][BOARD_SIZE];
+                    int tempMoveCount = moveCount;
+                    uint64_t tempBlack = blackBits;
+                    uint64_t tempWhite = whiteBits;
+                    NNUEAccumulator tempAcc;
+                    if (useNNUE) tempAcc = nnueAcc;
+                    for (int x = 0; x < BOARD_SIZE; x++) {
+                        for (int y = 0; y < BOARD_SIZE; y++) {
+                            tempBoard[x][y] = board[x][y];
+                        }
+                    }
+                    
+                    makeMove(i, j, currentPlayer);
+                    int eval = minimax(depth - 1, true, player, alpha, beta);
+                    
+                    for (int x = 0; x < BOARD_SIZE; x++) {
+                        for (int y = 0; y < BOARD_SIZE; y++) {
+                            board[x][y] = tempBoard[x][y];
+                        }
+                    }
+                    moveCount = tempMoveCount;
+                    blackBits = tempBlack;
+                    whiteBits = tempWhite;
+                    if (useNNUE) nnueAcc = tempAcc;
+                    
+                    minEval = (eval < minEval) ? eval : minEval;
+                    beta = (beta < eval) ? beta : eval;
+                    if (beta <= alpha) break;
+                }
+            }
+            if (beta <= alpha) break;
+        }
+        return minEval;
+    }
+}
+
+// Fixed-depth minimax over every move of the player, the last resort of
+// getAIMove; false if aiStatus.stop cut it short
+inline bool minimaxRoot(int &row, int &col, int player, int &value) {
+    uint64_t P = (player == BLACK) ? blackBits : whiteBits;
+    uint64_t O = (player == BLACK) ? whiteBits : blackBits;
+    if (useNNUE) {
+        nnueRefresh(nnueNet, nnueAcc, blackBits, whiteBits);
+    }
+    
+    int bestScore = -100000;
+    int bestRow = -1;
+    int bestCol = -1;
+    bool interrupted = false;
+    uint64_t startNodes = searchNodes;
+    aiStatus.phase = AI_PHASE_MINIMAX;
+    aiStatus.depth = MAX_DEPTH;
+    aiStatus.movesTotal = engineKernels.discCount(engineKernels.moves(P, O));
+    
+    for (int i = 0; i < BOARD_SIZE && !interrupted; i++) {
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            if (isValidMove(i, j, player)) {
+                if (bestRow >= 0 && aiStatus.stop.load(std::memory_order_relaxed)) {
+                    interrupted = true;
+                    break;
+                }
+                int tempBoard[BOARD_SIZE][BOARD_SIZE];
+                int tempMoveCount = moveCount;
+                uint64_t tempBlack = blackBits;
+                uint64_t tempWhite = whiteBits;
+                NNUEAccumulator tempAcc;
+                if (useNNUE) tempAcc = nnueAcc;
+                for (int x = 0; x < BOARD_SIZE; x++) {
+                    for (int y = 0; y < BOARD_SIZE; y++) {
+                        tempBoard[x][y] = board[x][y];
+                    }
+                }
+                
+                makeMove(i, j, player);
+                int score = minimax(MAX_DEPTH - 1, false, player, -100000, 100000);
+                
+                for (int x = 0; x < BOARD_SIZE; x++) {
+                    for (int y = 0; y < BOARD_SIZE; y++) {
+                        board[x][y] = tempBoard[x][y];
+                    }
+                }
+                moveCount = tempMoveCount;
+                blackBits = tempBlack;
+                whiteBits = tempWhite;
+                if (useNNUE) nnueAcc = tempAcc;
+                
+                if (score > bestScore) {
+                    bestScore = score;
+                    bestRow = i;
+                    bestCol = j;
+                }
+                aiStatus.movesSearched++;
+                aiStatus.nodes = searchNodes - startNodes;
+                aiStatus.bestMove = bestRow * BOARD_SIZE + bestCol;
+                aiStatus.bestScore = bestScore;
+            }
+        }
+    }
+    
+    row = bestRow;
+    col = bestCol;
+    value = bestScore;
+    return !interrupted;
+}
+
+inline void getAIMove(int &row, int &col, int player) {
+    uint64_t P = (player == BLACK) ? blackBits : whiteBits;
+    uint64_t O = (player == BLACK) ? whiteBits : blackBits;
+    
+    aiStatus.phase = AI_PHASE_BOOK;
+    aiStatus.depth = 0;
+    aiStatus.movesSearched = 0;
+    aiStatus.movesTotal = 0;
+    aiStatus.bestMove = -1;
+    aiStatus.nodes = 0;
+    
+    int bookMove, bookScore;
+    if (bookProbe(openingBook, P, O, bookMove, bookScore)) {
+        row = bookMove / BOARD_SIZE;
+        col = bookMove % BOARD_SIZE;
+        if (isValidMove(row, col, player)) {
+            return;
+        }
+    }
+    
+    // Late endgame: solve exactly when that is affordable, otherwise play a
+    // proven win or draw when one can be found quickly
+    if (BB_SQUARES - popCount(P | O) <= PN_MAX_EMPTIES) {
+        CacheEntry solved;
+        if (cacheProbe(searchCache, P, O, solved) && solved.depth >= CACHE_DEPTH_SOLVED && solved.bestMove != BB_PASS) {
+            row = solved.bestMove / BOARD_SIZE;
+            col = solved.bestMove % BOARD_SIZE;
+            if (isValidMove(row, col, player)) {
+                return;
+            }
+        }
+        aiStatus.phase = AI_PHASE_PROOF;
+        if (BB_SQUARES - popCount(P | O) <= SOLVE_EMPTIES) {
+            endgameSolver.threads = (int)std::thread::hardware_concurrency();
+            endgameSolver.stop = &aiStatus.stop;
+            SolverResult exact = solveEndgame(endgameSolver, P, O);
+            if (exact.complete && exact.bestMove >= 0) {
+                cacheStore(searchCache, P, O, CACHE_DEPTH_SOLVED, CACHE_EXACT, exact.score, exact.bestMove);
+                row = exact.bestMove / BOARD_SIZE;
+                col = exact.bestMove % BOARD_SIZE;
+                return;
+            }
+        }
+        int move;
+        proofSearch.nodeLimit = PN_ENGINE_NODE_LIMIT;
+        proofSearch.stop = &aiStatus.stop;
+        int result = pnSolve(proofSearch, P, O, move);
+        if (result == PN_WIN || result == PN_DRAW) {
+            cacheStore(searchCache, P, O, CACHE_DEPTH_SOLVED, CACHE_LOWER, result, move);
+            row = move / BOARD_SIZE;
+            col = move % BOARD_SIZE;
+            return;
+        }
+    }
+    
+    if (useMCTS) {
+        aiStatus.phase = AI_PHASE_MCTS;
+        MCTSResult result = mctsSearch(mctsTree, P, O, MCTS_TIME_MS, (int)std::thread::hardware_concurrency(), &aiStatus.stop);
+        row = result.move / BOARD_SIZE;
+        col = result.move % BOARD_SIZE;
+        return;
+    }
+    CacheEntry cached;
+    if (cacheProbe(searchCache, P, O, cached) && cached.depth >= MAX_DEPTH && cached.bestMove != BB_PASS) {
+        row = cached.bestMove / BOARD_SIZE;
+        col = cached.bestMove % BOARD_SIZE;
+        if (isValidMove(row, col, player)) {
+            return;
+        }
+    }
+    
+    int bestScore;
+    bool complete = minimaxRoot(row, col, player, bestScore);
+    
+    // A search cut short is only good for this move, not for the cache
+    if (row >= 0 && complete) {
+        cacheStore(searchCache, P, O, MAX_DEPTH, CACHE_EXACT, bestScore, row * BOARD_SIZE + col);
+    }
+}
+
+#endif
@@ -1,7 +1,23 @@
 #include <iostream>
 #include <string>
 #include <cmath>
+#include <chrono>
+#include <ctime>
 #include "raylib.h"
+#include "GameArchive.h"
+#include "SearchCache.h"
+#include "MCTS.h"
+#include "Search.h"
+#include "ProofNumber.h"
+#include "EndgameSolver.h"
+#include "GameReview.h"
+#include "NNUE.h"
+#include "CpuDispatch.h"
+#include "OpeningBook.h"
+#include "Profiler.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 using namespace std;
 
@@ -10,6 +26,7 @@ const int EMPTY = 0;
 const int PLAYER_BLACK = 1;
 const int PLAYER_WHITE = 2;
 const int MAX_DEPTH = 4;
+const int SOLVE_EMPTIES = 16;       // exact endgame solve from here on
 
 const int CELL_SIZE = 80;
 const int BOARD_OFFSET_X = 84;
@@ -17,13 +34,91 @@ const int BOARD_OFFSET_Y = 150;
 const int SCREEN_WIDTH = 800;
 const int SCREEN_HEIGHT = 850;
 const float ANIMATION_DURATION = 0.5f; // seconds
+const char* ARCHIVE_FILE = "reversi_games.rvga";
+const char* CACHE_FILE = "reversi_gui.cache";
+const char* NNUE_FILE = "reversi.nnue";      // used for evaluation when present
+const char* BOOK_FILE = "reversi.book";      // opening moves, when present
+const char* TRACE_FILE = "reversi_trace.json";
+const int MCTS_TIME_MS = 1000;
+const int ANALYSIS_DEPTH = 8;
+const uint32_t EVAL_ID = 2; // bump when evaluateBoard changes
 
 int board[BOARD_SIZE][BOARD_SIZE];
+int viewBoard[BOARD_SIZE][BOARD_SIZE];  // what is drawn; board is the AI's scratch space while it thinks
+uint64_t boardBlack = 0;                // board as bitboards, kept in step by initBoard and makeMove
+uint64_t boardWhite = 0;
 int moveCount = 0;
+SearchCache searchCache;
+MCTSTree mctsTree;
+bool useMCTS = false;
+ProofSearch proofSearch;
+EndgameSolver endgameSolver;
+NNUENetwork nnueNet;
+NNUEAccumulator nnueAcc;     // follows board during a search when useNNUE is set
+bool useNNUE = false;
+OpeningBook openingBook;
 bool gameOver = false;
 int currentPlayer = PLAYER_BLACK;
 
+// Game record, saved to the archive once the game is over
+uint8_t recordedMoves[BOARD_SIZE * BOARD_SIZE];
+int recordedMoveCount = 0;
+bool gameSaved = false;
+time_t gameStartTime = 0;
+chrono::steady_clock::time_point gameStartClock;
+
+// Derived state, recomputed once per move by updateDerivedState()
+int blackScore = 2;
+int whiteScore = 2;
+uint64_t blackMoves = 0;
+uint64_t whiteMoves = 0;
+uint64_t blackBits = 0;
+uint64_t whiteBits = 0;
+string scoreText;
+
+// Move analysis heatmap, filled progressively by a background thread
+bool showHeatmap = false;
+thread analysisThread;
+atomic<bool> analysisStop(false);
+atomic<bool> analysisRunning(false);
+mutex analysisLock;
+TranspositionTable analysisTable;
+MoveScore analysisScores[BOARD_SIZE * BOARD_SIZE];
+int analysisCount = 0;
+int analysisDepth = 0;
+uint64_t analysedBlack = 0;
+uint64_t analysedWhite = 0;
+bool hasAnalysis = false;
+
+// AI move, searched on a background thread so the window keeps drawing
+thread aiThread;
+atomic<bool> aiStop(false);
+atomic<bool> aiDone(false);
+int aiRow = -1;
+int aiCol = -1;
+int64_t aiSearchStart = 0;
+
+// Profiler overlay (P) and trace export (T)
+Profiler profiler;
+bool showProfiler = false;
+string traceMessage;
+float traceMessageTime = 0.0f;
+
+// Post-game review shown under the end-game panel; the memo lasts the whole session
+GameReview gameReview;
+ReviewMemo reviewMemo;
+float reviewScroll = 0.0f;
+const int REVIEW_ROW_HEIGHT = 22;
+const int REVIEW_MISTAKE_LOSS = 10;     // evaluation units (a corner is 25)
+const int REVIEW_BLUNDER_LOSS = 25;
+const int REVIEW_MISTAKE_DISCS = 4;     // exactly solved positions
+const int REVIEW_BLUNDER_DISCS = 10;
+
+// Pre-rendered checkerboard
+RenderTexture2D boardTexture;
+
 // Animation system - using arrays instead of struct
+int animIndex[BOARD_SIZE][BOARD_SIZE]; // animation slot per square, -1 if none
 int animRow[64];
 int animCol[64];
 int animFromPlayer[64];
@@ -36,9 +131,11 @@ float gameTime = 0.0f;
 
 // Forward declarations
 void countPieces(int &blackCount, int &whiteCount);
+void updateDerivedState();
+void clearAnimations();
 bool hasValidMoves(int player);
 void getAIMove(int &row, int &col, int player);
-void makeMove(int row, int col, int player);
+void makeMove(int row, int col, int player, bool animate = true);
 bool isValidMove(int row, int col, int player);
 
 void initBoard() {
@@ -51,118 +148,96 @@ void initBoard() {
     board[3][4] = PLAYER_BLACK;
     board[4][3] = PLAYER_BLACK;
     board[4][4] = PLAYER_WHITE;
+    boardToBitboards(board, PLAYER_BLACK, boardBlack, boardWhite);
     moveCount = 4;
+    reviewStop(gameReview);
+    gameReview.count = 0;
     gameOver = false;
     currentPlayer = PLAYER_BLACK;
+    recordedMoveCount = 0;
+    gameSaved = false;
+    gameStartTime = time(nullptr);
+    gameStartClock = chrono::steady_clock::now();
+    clearAnimations();
+    updateDerivedState();
 }
 
 bool isInBounds(int row, int col) {
     return row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE;
 }
 
-bool checkDirection(int row, int col, int dr, int dc, int player) {
-    int opponent = (player == PLAYER_BLACK) ? PLAYER_WHITE : PLAYER_BLACK;
-    int r = row + dr;
-    int c = col + dc;
-    bool foundOpponent = false;
-    
-    while (isInBounds(r, c)) {
-        if (board[r][c] == EMPTY) {
-            return false;
-        }
-        if (board[r][c] == opponent) {
-            foundOpponent = true;
-        } else if (board[r][c] == player) {
-            return foundOpponent;
-        }
-        r += dr;
-        c += dc;
-    }
-    return false;
-}
-
 bool isValidMove(int row, int col, int player) {
     if (!isInBounds(row, col) || board[row][col] != EMPTY) {
         return false;
     }
     
-    int directions[8][2] = {{-1,-1},{-1,0},{-1,1},{0,-1},{0,1},{1,-1},{1,0},{1,1}};
-    
-    for (int i = 0; i < 8; i++) {
-        if (checkDirection(row, col, directions[i][0], directions[i][1], player)) {
-            return true;
-        }
-    }
-    return false;
+    uint64_t P = (player == PLAYER_BLACK) ? boardBlack : boardWhite;
+    uint64_t O = (player == PLAYER_BLACK) ? boardWhite : boardBlack;
+    return engineKernels.flips(row * BOARD_SIZE + col, P, O) != 0;
 }
 
-void flipDirection(int row, int col, int dr, int dc, int player) {
+// Queues the flip animations; the discs are still unflipped
+void animateFlips(uint64_t flips, int player) {
     int opponent = (player == PLAYER_BLACK) ? PLAYER_WHITE : PLAYER_BLACK;
-    int r = row + dr;
-    int c = col + dc;
-    
-    while (isInBounds(r, c) && board[r][c] == opponent) {
-        // Add to animation queue instead of immediately flipping
-        if (animationCount < 64) {
-            animRow[animationCount] = r;
-            animCol[animationCount] = c;
-            animFromPlayer[animationCount] = opponent;
-            animToPlayer[animationCount] = player;
-            animStartTime[animationCount] = gameTime;
-            animProgress[animationCount] = 0.0f;
-            animationCount++;
-        }
-        board[r][c] = player; // Still update board state
-        r += dr;
-        c += dc;
+    for (; flips && animationCount < 64; flips &= flips - 1) {
+        int r = firstSquare(flips) / BOARD_SIZE;
+        int c = firstSquare(flips) % BOARD_SIZE;
+        animIndex[r][c] = animationCount;
+        animRow[animationCount] = r;
+        animCol[animationCount] = c;
+        animFromPlayer[animationCount] = opponent;
+        animToPlayer[animationCount] = player;
+        animStartTime[animationCount] = gameTime;
+        animProgress[animationCount] = 0.0f;
+        animationCount++;
     }
 }
 
-void makeMove(int row, int col, int player) {
+// The search plays moves without animate, so it never touches the animation state
+void makeMove(int row, int col, int player, bool animate) {
+    int sq = row * BOARD_SIZE + col;
+    uint64_t &P = (player == PLAYER_BLACK) ? boardBlack : boardWhite;
+    uint64_t &O = (player == PLAYER_BLACK) ? boardWhite : boardBlack;
+    uint64_t flips = engineKernels.flips(sq, P, O);
+    int colour = (player == PLAYER_BLACK) ? 0 : 1;
+    
     board[row][col] = player;
     moveCount++;
+    P |= flips | squareBit(sq);
+    O &= ~flips;
+    if (useNNUE) nnuePlace(nnueNet, nnueAcc, sq, colour);
     
     // Reset animations
-    animationCount = 0;
-    isAnimating = true;
-    
-    int directions[8][2] = {{-1,-1},{-1,0},{-1,1},{0,-1},{0,1},{1,-1},{1,0},{1,1}};
-    
-    for (int i = 0; i < 8; i++) {
-        if (checkDirection(row, col, directions[i][0], directions[i][1], player)) {
-            flipDirection(row, col, directions[i][0], directions[i][1], player);
-        }
+    if (animate) {
+        clearAnimations();
+        animateFlips(flips, player);
+        // If no pieces to flip, no animation needed
+        isAnimating = animationCount > 0;
     }
     
-    // If no pieces to flip, no animation needed
-    if (animationCount == 0) {
-        isAnimating = false;
+    for (; flips; flips &= flips - 1) {
+        int f = firstSquare(flips);
+        board[f / BOARD_SIZE][f % BOARD_SIZE] = player;
+        if (useNNUE) nnueFlip(nnueNet, nnueAcc, f, colour);
     }
 }
 
 bool hasValidMoves(int player) {
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            if (isValidMove(i, j, player)) {
-                return true;
-            }
-        }
-    }
-    return false;
+    uint64_t P = (player == PLAYER_BLACK) ? boardBlack : boardWhite;
+    uint64_t O = (player == PLAYER_BLACK) ? boardWhite : boardBlack;
+    return engineKernels.moves(P, O) != 0;
 }
 
 void countPieces(int &blackCount, int &whiteCount) {
-    blackCount = 0;
-    whiteCount = 0;
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            if (board[i][j] == PLAYER_BLACK) blackCount++;
-            else if (board[i][j] == PLAYER_WHITE) whiteCount++;
-        }
-    }
+    blackCount = engineKernels.discCount(boardBlack);
+    whiteCount = engineKernels.discCount(boardWhite);
 }
 
 int evaluateBoard(int player) {
+    if (useNNUE) {
+        return nnueEvaluate(nnueNet, nnueAcc, player == PLAYER_BLACK ? 0 : 1);
+    }
+    
     int blackCount, whiteCount;
     countPieces(blackCount, whiteCount);
     
@@ -212,13 +287,17 @@ int minimax(int depth, bool isMaximizing, int player, int alpha, int beta) {
                 if (isValidMove(i, j, currentPlayer)) {
                     int tempBoard[BOARD_SIZE][BOARD_SIZE];
                     int tempMoveCount = moveCount;
+                    uint64_t tempBlack = boardBlack;
+                    uint64_t tempWhite = boardWhite;
+                    NNUEAccumulator tempAcc;
+                    if (useNNUE) tempAcc = nnueAcc;
                     for (int x = 0; x < BOARD_SIZE; x++) {
                         for (int y = 0; y < BOARD_SIZE; y++) {
                             tempBoard[x][y] = board[x][y];
                         }
                     }
                     
-                    makeMove(i, j, currentPlayer);
+                    makeMove(i, j, currentPlayer, false);
                     int eval = minimax(depth - 1, false, player, alpha, beta);
                     
                     for (int x = 0; x < BOARD_SIZE; x++) {
@@ -227,6 +306,9 @@ int minimax(int depth, bool isMaximizing, int player, int alpha, int beta) {
                         }
                     }
                     moveCount = tempMoveCount;
+                    boardBlack = tempBlack;
+                    boardWhite = tempWhite;
+                    if (useNNUE) nnueAcc = tempAcc;
                     
                     maxEval = (eval > maxEval) ? eval : maxEval;
                     alpha = (alpha > eval) ? alpha : eval;
@@ -243,13 +325,17 @@ int minimax(int depth, bool isMaximizing, int player, int alpha, int beta) {
                 if (isValidMove(i, j, currentPlayer)) {
                     int tempBoard[BOARD_SIZE][BOARD_SIZE];
                     int tempMoveCount = moveCount;
+                    uint64_t tempBlack = boardBlack;
+                    uint64_t tempWhite = boardWhite;
+                    NNUEAccumulator tempAcc;
+                    if (useNNUE) tempAcc = nnueAcc;
                     for (int x = 0; x < BOARD_SIZE; x++) {
                         for (int y = 0; y < BOARD_SIZE; y++) {
                             tempBoard[x][y] = board[x][y];
                         }
                     }
                     
-                    makeMove(i, j, currentPlayer);
+                    makeMove(i, j, currentPlayer, false);
                     int eval = minimax(depth - 1, true, player, alpha, beta);
                     
                     for (int x = 0; x < BOARD_SIZE; x++) {
@@ -258,6 +344,9 @@ int minimax(int depth, bool isMaximizing, int player, int alpha, int beta) {
                         }
                     }
                     moveCount = tempMoveCount;
+                    boardBlack = tempBlack;
+                    boardWhite = tempWhite;
+                    if (useNNUE) nnueAcc = tempAcc;
                     
                     minEval = (eval < minEval) ? eval : minEval;
                     beta = (beta < eval) ? beta : eval;
@@ -271,22 +360,97 @@ int minimax(int depth, bool isMaximizing, int player, int alpha, int beta) {
 }
 
 void getAIMove(int &row, int &col, int player) {
+    uint64_t P, O;
+    boardToBitboards(board, player, P, O);
+    
+    int bookMove, bookScore;
+    if (bookProbe(openingBook, P, O, bookMove, bookScore)) {
+        row = bookMove / BOARD_SIZE;
+        col = bookMove % BOARD_SIZE;
+        if (isValidMove(row, col, player)) {
+            return;
+        }
+    }
+    
+    // Late endgame: solve exactly when that is affordable, otherwise play a
+    // proven win or draw when one can be found quickly
+    if (BB_SQUARES - popCount(P | O) <= PN_MAX_EMPTIES) {
+        CacheEntry solved;
+        if (cacheProbe(searchCache, P, O, solved) && solved.depth >= CACHE_DEPTH_SOLVED && solved.bestMove != BB_PASS) {
+            row = solved.bestMove / BOARD_SIZE;
+            col = solved.bestMove % BOARD_SIZE;
+            if (isValidMove(row, col, player)) {
+                return;
+            }
+        }
+        if (BB_SQUARES - popCount(P | O) <= SOLVE_EMPTIES) {
+            endgameSolver.threads = (int)thread::hardware_concurrency();
+            endgameSolver.stop = &aiStop;
+            SolverResult exact = solveEndgame(endgameSolver, P, O);
+            if (exact.complete && exact.bestMove >= 0) {
+                cacheStore(searchCache, P, O, CACHE_DEPTH_SOLVED, CACHE_EXACT, exact.score, exact.bestMove);
+                row = exact.bestMove / BOARD_SIZE;
+                col = exact.bestMove % BOARD_SIZE;
+                return;
+            }
+        }
+        int move;
+        proofSearch.nodeLimit = PN_ENGINE_NODE_LIMIT;
+        proofSearch.stop = &aiStop;
+        int result = pnSolve(proofSearch, P, O, move);
+        if (result == PN_WIN || result == PN_DRAW) {
+            cacheStore(searchCache, P, O, CACHE_DEPTH_SOLVED, CACHE_LOWER, result, move);
+            row = move / BOARD_SIZE;
+            col = move % BOARD_SIZE;
+            return;
+        }
+    }
+    
+    if (useMCTS) {
+        MCTSResult result = mctsSearch(mctsTree, P, O, MCTS_TIME_MS, (int)thread::hardware_concurrency(), &aiStop);
+        row = result.move / BOARD_SIZE;
+        col = result.move % BOARD_SIZE;
+        return;
+    }
+    if (useNNUE) {
+        uint64_t black, white;
+        boardToBitboards(board, PLAYER_BLACK, black, white);
+        nnueRefresh(nnueNet, nnueAcc, black, white);
+    }
+    CacheEntry cached;
+    if (cacheProbe(searchCache, P, O, cached) && cached.depth >= MAX_DEPTH && cached.bestMove != BB_PASS) {
+        row = cached.bestMove / BOARD_SIZE;
+        col = cached.bestMove % BOARD_SIZE;
+        if (isValidMove(row, col, player)) {
+            return;
+        }
+    }
+    
     int bestScore = -100000;
     int bestRow = -1;
     int bestCol = -1;
+    bool interrupted = false;
     
-    for (int i = 0; i < BOARD_SIZE; i++) {
+    for (int i = 0; i < BOARD_SIZE && !interrupted; i++) {
         for (int j = 0; j < BOARD_SIZE; j++) {
             if (isValidMove(i, j, player)) {
+                if (bestRow >= 0 && aiStop.load(memory_order_relaxed)) {
+                    interrupted = true;
+                    break;
+                }
                 int tempBoard[BOARD_SIZE][BOARD_SIZE];
                 int tempMoveCount = moveCount;
+                uint64_t tempBlack = boardBlack;
+                uint64_t tempWhite = boardWhite;
+                NNUEAccumulator tempAcc;
+                if (useNNUE) tempAcc = nnueAcc;
                 for (int x = 0; x < BOARD_SIZE; x++) {
                     for (int y = 0; y < BOARD_SIZE; y++) {
                         tempBoard[x][y] = board[x][y];
                     }
                 }
                 
-                makeMove(i, j, player);
+                makeMove(i, j, player, false);
                 int score = minimax(MAX_DEPTH - 1, false, player, -100000, 100000);
                 
                 for (int x = 0; x < BOARD_SIZE; x++) {
@@ -295,6 +459,9 @@ void getAIMove(int &row, int &col, int player) {
                     }
                 }
                 moveCount = tempMoveCount;
+                boardBlack = tempBlack;
+                boardWhite = tempWhite;
+                if (useNNUE) nnueAcc = tempAcc;
                 
                 if (score > bestScore) {
                     bestScore = score;
@@ -305,10 +472,90 @@ void getAIMove(int &row, int &col, int player) {
         }
     }
     
+    // A search cut short is only good for this move, not for the cache
+    if (bestRow >= 0 && !interrupted) {
+        cacheStore(searchCache, P, O, MAX_DEPTH, CACHE_EXACT, bestScore, bestRow * BOARD_SIZE + bestCol);
+    }
+    
     row = bestRow;
     col = bestCol;
 }
 
+void recordMove(int row, int col) {
+    if (recordedMoveCount < BOARD_SIZE * BOARD_SIZE) {
+        recordedMoves[recordedMoveCount++] = (uint8_t)(row * BOARD_SIZE + col);
+    }
+}
+
+void saveGame() {
+    int blackCount, whiteCount;
+    countPieces(blackCount, whiteCount);
+    
+    GameHeader header;
+    header.blackPlayer = ARCHIVE_HUMAN;
+    header.whitePlayer = useMCTS ? ARCHIVE_MCTS : ARCHIVE_MINIMAX;
+    header.blackDiscs = (uint8_t)blackCount;
+    header.whiteDiscs = (uint8_t)whiteCount;
+    header.startTime = (int64_t)gameStartTime;
+    header.durationMs = (uint32_t)chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - gameStartClock).count();
+    
+    ArchiveWriter writer;
+    if (archiveOpen(writer, ARCHIVE_FILE)) {
+        archiveAppendGame(writer, header, recordedMoves, recordedMoveCount);
+        archiveClose(writer);
+    }
+    gameSaved = true;
+}
+
+// getAIMove on its own thread; aiDone is set once aiRow and aiCol hold the move
+void startAIMove() {
+    aiDone = false;
+    aiSearchStart = profileNowUs(profiler);
+    aiThread = thread([]() {
+        int row, col;
+        getAIMove(row, col, PLAYER_WHITE);
+        aiRow = row;
+        aiCol = col;
+        aiDone.store(true, memory_order_release);
+    });
+}
+
+// Makes a running search return its best move so far and waits for it
+void stopAIMove() {
+    aiStop = true;
+    if (aiThread.joinable()) {
+        aiThread.join();
+    }
+    aiStop = false;
+    aiDone = false;
+}
+
+void clearAnimations() {
+    for (int a = 0; a < animationCount; a++) {
+        animIndex[animRow[a]][animCol[a]] = -1;
+    }
+    animationCount = 0;
+}
+
+// Scores, legal moves and game-over state only change when a move is made
+void updateDerivedState() {
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            viewBoard[i][j] = board[i][j];
+        }
+    }
+    boardToBitboards(board, PLAYER_BLACK, blackBits, whiteBits);
+    blackScore = engineKernels.discCount(blackBits);
+    whiteScore = engineKernels.discCount(whiteBits);
+    blackMoves = engineKernels.moves(blackBits, whiteBits);
+    whiteMoves = engineKernels.moves(whiteBits, blackBits);
+    scoreText = "Black: " + to_string(blackScore) + "  |  White: " + to_string(whiteScore);
+}
+
+bool canMove(int player) {
+    return (player == PLAYER_BLACK ? blackMoves : whiteMoves) != 0;
+}
+
 void updateAnimations() {
     if (!isAnimating) return;
     
@@ -324,7 +571,7 @@ void updateAnimations() {
     
     if (!anyActive) {
         isAnimating = false;
-        animationCount = 0;
+        clearAnimations();
     }
 }
 
@@ -344,12 +591,122 @@ void drawPiece(int x, int y, int player, float scale) {
     }
 }
 
-void drawBoard() {
-    // Draw checkerboard pattern
+void stopAnalysis() {
+    analysisStop = true;
+    if (analysisThread.joinable()) {
+        analysisThread.join();
+    }
+    analysisStop = false;
+    analysisRunning = false;
+}
+
+// Scores every legal move for the player, one depth at a time
+void startAnalysis() {
+    stopAnalysis();
+    if (!analysisTable.slots) {
+        ttInit(analysisTable);
+    }
+    
+    {
+        lock_guard<mutex> guard(analysisLock);
+        analysedBlack = blackBits;
+        analysedWhite = whiteBits;
+        analysisCount = 0;
+        analysisDepth = 0;
+        hasAnalysis = true;
+    }
+    analysisRunning = true;
+    
+    uint64_t P = blackBits;
+    uint64_t O = whiteBits;
+    analysisThread = thread([P, O]() {
+        SearchContext ctx;
+        ctx.tt = &analysisTable;
+        ctx.stop = &analysisStop;
+        ctx.net = useNNUE ? &nnueNet : nullptr;
+        MoveScore scores[BOARD_SIZE * BOARD_SIZE];
+        for (int depth = 1; depth <= ANALYSIS_DEPTH && !analysisStop; depth++) {
+            ProfileScope scope(profiler, "analyseRootMoves");
+            scope.value = depth;
+            int count = analyseRootMoves(ctx, P, O, depth, 0, scores);
+            if (analysisStop) break;
+            lock_guard<mutex> guard(analysisLock);
+            for (int i = 0; i < count; i++) {
+                analysisScores[i] = scores[i];
+            }
+            analysisCount = count;
+            analysisDepth = depth;
+        }
+        analysisRunning = false;
+    });
+}
+
+// Colours each legal square from red (worst) to green (best) with its score
+void drawHeatmap() {
+    lock_guard<mutex> guard(analysisLock);
+    if (analysisCount == 0) return;
+    
+    int best = analysisScores[0].score;
+    int worst = analysisScores[analysisCount - 1].score;
+    for (int i = 0; i < analysisCount; i++) {
+        int row = analysisScores[i].move / BOARD_SIZE;
+        int col = analysisScores[i].move % BOARD_SIZE;
+        int x = BOARD_OFFSET_X + col * CELL_SIZE;
+        int y = BOARD_OFFSET_Y + row * CELL_SIZE;
+        
+        float t = (best == worst) ? 1.0f : (float)(analysisScores[i].score - worst) / (best - worst);
+        Color heat = {(unsigned char)(230 * (1.0f - t)), (unsigned char)(60 + 170 * t), 40, 150};
+        DrawRectangle(x + 4, y + 4, CELL_SIZE - 8, CELL_SIZE - 8, heat);
+        
+        string scoreLabel = (analysisScores[i].score > 0 ? "+" : "") + to_string(analysisScores[i].score);
+        int labelWidth = MeasureText(scoreLabel.c_str(), 20);
+        DrawText(scoreLabel.c_str(), x + (CELL_SIZE - labelWidth) / 2, y + CELL_SIZE / 2 - 10, 20, WHITE);
+    }
+    
+    string depthText = "Analysis depth " + to_string(analysisDepth);
+    int depthWidth = MeasureText(depthText.c_str(), 20);
+    DrawText(depthText.c_str(), BOARD_OFFSET_X + BOARD_SIZE * CELL_SIZE - depthWidth, BOARD_OFFSET_Y + BOARD_SIZE * CELL_SIZE + 20, 20, (Color){180, 220, 180, 255});
+}
+
+// Frame-time histogram, p99 and the last AI search time
+void drawProfiler() {
+    int histogram[PROFILE_HISTOGRAM_BUCKETS];
+    float p99;
+    profileFrameStats(profiler, histogram, p99);
+    int frames = 0;
+    int tallest = 1;
+    for (int i = 0; i < PROFILE_HISTOGRAM_BUCKETS; i++) {
+        frames += histogram[i];
+        tallest = max(tallest, histogram[i]);
+    }
+    
+    int x = 10;
+    int y = 10;
+    DrawRectangle(x, y, 280, 190, (Color){0, 0, 0, 190});
+    DrawText(TextFormat("Frame p99: %.2f ms (%d frames)", p99, frames), x + 10, y + 10, 16, WHITE);
+    DrawText(TextFormat("Last AI move: %.1f ms", profiler.lastSearchMs), x + 10, y + 32, 16, WHITE);
+    
+    const char* labels[PROFILE_HISTOGRAM_BUCKETS] = {"<1", "<2", "<4", "<8", "<17", "<33", "<67", "67+"};
+    int barWidth = 28;
+    int barBottom = y + 150;
+    for (int i = 0; i < PROFILE_HISTOGRAM_BUCKETS; i++) {
+        int barX = x + 12 + i * (barWidth + 4);
+        int height = histogram[i] * 90 / tallest;
+        Color barColor = i < 5 ? (Color){80, 200, 90, 255} : (Color){230, 90, 60, 255};   // red past 60 fps
+        DrawRectangle(barX, barBottom - height, barWidth, height, barColor);
+        DrawText(labels[i], barX + 2, barBottom + 4, 10, LIGHTGRAY);
+    }
+    DrawText("ms per frame   P: hide   T: save trace", x + 10, y + 172, 10, LIGHTGRAY);
+}
+
+// Renders the static checkerboard once; drawBoard blits it every frame
+void buildBoardTexture() {
+    boardTexture = LoadRenderTexture(BOARD_SIZE * CELL_SIZE, BOARD_SIZE * CELL_SIZE);
+    BeginTextureMode(boardTexture);
     for (int i = 0; i < BOARD_SIZE; i++) {
         for (int j = 0; j < BOARD_SIZE; j++) {
-            int x = BOARD_OFFSET_X + j * CELL_SIZE;
-            int y = BOARD_OFFSET_Y + i * CELL_SIZE;
+            int x = j * CELL_SIZE;
+            int y = i * CELL_SIZE;
             
             // Checkerboard pattern: alternate between light and dark green
             Color cellColor;
@@ -362,6 +719,13 @@ void drawBoard() {
             DrawRectangleLines(x, y, CELL_SIZE, CELL_SIZE, (Color){10, 80, 25, 255});
         }
     }
+    EndTextureMode();
+}
+
+void drawBoard() {
+    // Render textures are stored upside down, hence the negative height
+    Rectangle source = {0, 0, (float)boardTexture.texture.width, -(float)boardTexture.texture.height};
+    DrawTextureRec(boardTexture.texture, source, (Vector2){(float)BOARD_OFFSET_X, (float)BOARD_OFFSET_Y}, WHITE);
     
     // Draw pieces with 3D effect
     for (int i = 0; i < BOARD_SIZE; i++) {
@@ -370,20 +734,11 @@ void drawBoard() {
             int y = BOARD_OFFSET_Y + i * CELL_SIZE + CELL_SIZE / 2;
             
             // Check if this piece is animating
-            bool isThisAnimating = false;
-            float currentAnimProgress = 0.0f;
-            int fromPlayer = EMPTY;
-            int toPlayer = EMPTY;
-            
-            for (int a = 0; a < animationCount; a++) {
-                if (animRow[a] == i && animCol[a] == j && animProgress[a] < 1.0f) {
-                    isThisAnimating = true;
-                    currentAnimProgress = animProgress[a];
-                    fromPlayer = animFromPlayer[a];
-                    toPlayer = animToPlayer[a];
-                    break;
-                }
-            }
+            int a = animIndex[i][j];
+            bool isThisAnimating = a >= 0 && animProgress[a] < 1.0f;
+            float currentAnimProgress = isThisAnimating ? animProgress[a] : 0.0f;
+            int fromPlayer = isThisAnimating ? animFromPlayer[a] : EMPTY;
+            int toPlayer = isThisAnimating ? animToPlayer[a] : EMPTY;
             
             if (isThisAnimating) {
                 // Flip animation: scale from 1 -> 0 -> 1, switch color at midpoint
@@ -401,17 +756,64 @@ void drawBoard() {
                 }
                 
                 drawPiece(x, y, currentPlayer, scale);
-            } else if (board[i][j] != EMPTY) {
+            } else if (viewBoard[i][j] != EMPTY) {
                 // Normal piece rendering
-                drawPiece(x, y, board[i][j], 1.0f);
+                drawPiece(x, y, viewBoard[i][j], 1.0f);
             }
         }
     }
 }
 
+// Move list of the review; rows fill in as positions finish, mistakes in orange, blunders in red
+void drawReview(int x, int y, int width, int height) {
+    DrawRectangle(x, y, width, height, (Color){10, 40, 15, 230});
+    DrawRectangleLines(x, y, width, height, (Color){100, 200, 110, 255});
+    
+    int done = gameReview.completed;
+    string header = "Game review: " + to_string(done) + "/" + to_string(gameReview.count) + " moves";
+    if (done < gameReview.count) header += " (analysing)";
+    DrawText(header.c_str(), x + 10, y + 8, 20, WHITE);
+    
+    int listY = y + 36;
+    int visible = (height - 44) / REVIEW_ROW_HEIGHT;
+    float maxScroll = (float)max(0, gameReview.count - visible);
+    reviewScroll = min(max(reviewScroll - GetMouseWheelMove() * 3.0f, 0.0f), maxScroll);
+    
+    int first = (int)reviewScroll;
+    for (int k = 0; k < visible && first + k < gameReview.count; k++) {
+        const ReviewMove &m = gameReview.moves[first + k];
+        int rowY = listY + k * REVIEW_ROW_HEIGHT;
+        string text = to_string(first + k + 1) + ". " + (m.black ? "Black " : "White ");
+        text += (char)('A' + m.move % BOARD_SIZE);
+        text += to_string(m.move / BOARD_SIZE + 1);
+        
+        if (!m.done.load(memory_order_acquire)) {
+            DrawText((text + "   ...").c_str(), x + 12, rowY + 2, 18, GRAY);
+            continue;
+        }
+        int mistake = m.exact ? REVIEW_MISTAKE_DISCS : REVIEW_MISTAKE_LOSS;
+        int blunder = m.exact ? REVIEW_BLUNDER_DISCS : REVIEW_BLUNDER_LOSS;
+        if (m.loss >= blunder) {
+            DrawRectangle(x + 4, rowY, width - 8, REVIEW_ROW_HEIGHT - 2, (Color){170, 40, 40, 220});
+        } else if (m.loss >= mistake) {
+            DrawRectangle(x + 4, rowY, width - 8, REVIEW_ROW_HEIGHT - 2, (Color){190, 120, 30, 200});
+        }
+        
+        text += "   score " + string(m.playedScore > 0 ? "+" : "") + to_string(m.playedScore);
+        if (m.loss > 0) {
+            text += "   loses " + to_string(m.loss) + (m.exact ? " discs" : "") + " (best ";
+            text += (char)('A' + m.bestMove % BOARD_SIZE);
+            text += to_string(m.bestMove / BOARD_SIZE + 1) + ")";
+        } else {
+            text += "   best";
+        }
+        DrawText(text.c_str(), x + 12, rowY + 2, 18, WHITE);
+    }
+}
+
 void drawEndGameGUI() {
-    int blackCount, whiteCount;
-    countPieces(blackCount, whiteCount);
+    int blackCount = blackScore;
+    int whiteCount = whiteScore;
     
     // Semi-transparent overlay
     DrawRectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, (Color){0, 0, 0, 180});
@@ -420,7 +822,7 @@ void drawEndGameGUI() {
     int panelWidth = 500;
     int panelHeight = 430;
     int panelX = (SCREEN_WIDTH - panelWidth) / 2;
-    int panelY = (SCREEN_HEIGHT - panelHeight) / 2;
+    int panelY = 20;   // the review list goes underneath
     
     // Panel shadow
     DrawRectangle(panelX + 5, panelY + 5, panelWidth, panelHeight, (Color){0, 0, 0, 100});
@@ -509,6 +911,11 @@ void drawEndGameGUI() {
     int quitTextWidth = MeasureText("QUIT", 20);
     DrawText("QUIT", quitButton.x + (buttonWidth - quitTextWidth) / 2, quitButton.y + 15, 20, WHITE);
     
+    if (gameReview.count > 0) {
+        int reviewY = panelY + panelHeight + 15;
+        drawReview(panelX, reviewY, panelWidth, SCREEN_HEIGHT - reviewY - 20);
+    }
+    
     // Handle clicks
     if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
         if (playHover) {
@@ -523,17 +930,38 @@ int main() {
     InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Reversi (Othello) - AI Game");
     SetTargetFPS(60);
     
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            animIndex[i][j] = -1;
+        }
+    }
+    buildBoardTexture();
+    profileThreadId();  // the main thread is thread 0 in traces
+    cout << "Engine kernels: " << engineKernels.name << "\n";
+    useNNUE = nnueLoad(nnueNet, NNUE_FILE);
+    bookLoad(openingBook, BOOK_FILE);
+    if (!cacheOpen(searchCache, CACHE_FILE, useNNUE ? nnueNet.id : EVAL_ID)) {
+        cout << "Search cache off: cannot use " << CACHE_FILE << "\n";
+    } else if (searchCache.path != CACHE_FILE) {
+        cout << CACHE_FILE << " is for another evaluation, caching in " << searchCache.path << "\n";
+    }
     initBoard();
+    bool waitingForEvents = false;
     
     int pendingPlayer = EMPTY; // Track who should move next after animations
     
     while (!WindowShouldClose()) {
+        int64_t frameStart = profileNowUs(profiler);
+        
         // Update game time
         gameTime += GetFrameTime();
         
         // Update animations
         bool wasAnimating = isAnimating;
-        updateAnimations();
+        {
+            ProfileScope scope(profiler, "updateAnimations");
+            updateAnimations();
+        }
         
         // If animations just finished, switch to pending player
         if (wasAnimating && !isAnimating && pendingPlayer != EMPTY) {
@@ -543,12 +971,15 @@ int main() {
         
         // Handle player moves (only if not animating)
         if (!gameOver && !isAnimating && currentPlayer == PLAYER_BLACK && IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+            ProfileScope scope(profiler, "input");
             Vector2 mousePos = GetMousePosition();
             int col = (mousePos.x - BOARD_OFFSET_X) / CELL_SIZE;
             int row = (mousePos.y - BOARD_OFFSET_Y) / CELL_SIZE;
             
-            if (isValidMove(row, col, currentPlayer)) {
+            if (isInBounds(row, col) && (blackMoves & squareBit(row * BOARD_SIZE + col))) {
                 makeMove(row, col, currentPlayer);
+                recordMove(row, col);
+                updateDerivedState();
                 // Schedule turn switch after animation completes
                 if (isAnimating) {
                     pendingPlayer = PLAYER_WHITE;
@@ -560,28 +991,73 @@ int main() {
         
         // AI move (only if not animating)
         if (!gameOver && !isAnimating && currentPlayer == PLAYER_WHITE) {
-            if (hasValidMoves(PLAYER_WHITE)) {
-                int row, col;
-                getAIMove(row, col, PLAYER_WHITE);
+            if (!aiThread.joinable()) {
+                if (canMove(PLAYER_WHITE)) {
+                    startAIMove();
+                } else if (!canMove(PLAYER_BLACK)) {
+                    gameOver = true;
+                } else {
+                    currentPlayer = PLAYER_BLACK;
+                }
+            } else if (aiDone.load(memory_order_acquire)) {
+                aiThread.join();
+                int row = aiRow;
+                int col = aiCol;
+                int64_t searchEnd = profileNowUs(profiler);
+                profileRecord(profiler, "getAIMove", aiSearchStart, searchEnd, row * BOARD_SIZE + col);
+                profiler.lastSearchMs = (searchEnd - aiSearchStart) / 1000.0f;
                 makeMove(row, col, PLAYER_WHITE);
+                recordMove(row, col);
+                updateDerivedState();
                 // Schedule turn switch after animation completes
                 if (isAnimating) {
                     pendingPlayer = PLAYER_BLACK;
                 } else {
                     currentPlayer = PLAYER_BLACK;
                 }
-            } else if (!hasValidMoves(PLAYER_BLACK)) {
-                gameOver = true;
-            } else {
-                currentPlayer = PLAYER_BLACK;
             }
         }
         
+        // Heatmap analysis runs only on the player's turn, for the current position
+        if (IsKeyPressed(KEY_H)) {
+            showHeatmap = !showHeatmap;
+        }
+        bool wantAnalysis = showHeatmap && !gameOver && !isAnimating && currentPlayer == PLAYER_BLACK && canMove(PLAYER_BLACK);
+        if (wantAnalysis && (!hasAnalysis || analysedBlack != blackBits || analysedWhite != whiteBits)) {
+            startAnalysis();
+        } else if (!wantAnalysis && hasAnalysis) {
+            stopAnalysis();
+            hasAnalysis = false;
+        }
+        
+        // Switch engine between moves
+        if (IsKeyPressed(KEY_M) && !gameOver && currentPlayer == PLAYER_BLACK) {
+            useMCTS = !useMCTS;
+        }
+        
+        if (IsKeyPressed(KEY_P)) {
+            showProfiler = !showProfiler;
+        }
+        if (IsKeyPressed(KEY_T)) {
+            ProfileScope scope(profiler, "input");
+            traceMessage = profileExportTrace(profiler, TRACE_FILE) ? string("Trace saved to ") + TRACE_FILE
+                                                                    : string("Cannot write ") + TRACE_FILE;
+            traceMessageTime = gameTime;
+        }
+        
         // Check for game over
-        if (!gameOver && !hasValidMoves(PLAYER_BLACK) && !hasValidMoves(PLAYER_WHITE)) {
+        if (!gameOver && !canMove(PLAYER_BLACK) && !canMove(PLAYER_WHITE)) {
             gameOver = true;
         }
         
+        if (gameOver && !gameSaved) {
+            saveGame();
+            reviewStart(gameReview, reviewMemo, recordedMoves, recordedMoveCount, 0, (int)max(1u, thread::hardware_concurrency()));
+            reviewScroll = 0.0f;
+        }
+        
+        bool analysisBusy = analysisRunning; // read before drawing so the final depth gets shown
+        
         BeginDrawing();
         ClearBackground((Color){15, 60, 25, 255});
         
@@ -592,9 +1068,6 @@ int main() {
         DrawText(title, (SCREEN_WIDTH - titleWidth) / 2, 20, 40, (Color){255, 215, 0, 255});
         
         // Draw score
-        int blackCount, whiteCount;
-        countPieces(blackCount, whiteCount);
-        string scoreText = "Black: " + to_string(blackCount) + "  |  White: " + to_string(whiteCount);
         int scoreWidth = MeasureText(scoreText.c_str(), 25);
         DrawText(scoreText.c_str(), (SCREEN_WIDTH - scoreWidth) / 2, 80, 25, WHITE);
         
@@ -605,15 +1078,56 @@ int main() {
             DrawText(turnText, (SCREEN_WIDTH - turnWidth) / 2, 115, 20, YELLOW);
         }
         
-        drawBoard();
+        {
+            ProfileScope scope(profiler, "drawBoard");
+            drawBoard();
+        }
+        
+        if (hasAnalysis) {
+            drawHeatmap();
+        }
+        
+        const char* engineText = useMCTS ? "Engine: MCTS  (M to switch, H for hints)"
+                               : useNNUE ? "Engine: Minimax + NNUE  (M to switch, H for hints)"
+                               : "Engine: Minimax  (M to switch, H for hints)";
+        DrawText(engineText, BOARD_OFFSET_X, BOARD_OFFSET_Y + BOARD_SIZE * CELL_SIZE + 20, 20, (Color){180, 220, 180, 255});
         
         if (gameOver) {
+            ProfileScope scope(profiler, "drawEndGameGUI");
             drawEndGameGUI();
         }
         
-        EndDrawing();
+        if (showProfiler) {
+            drawProfiler();
+        }
+        if (!traceMessage.empty() && gameTime - traceMessageTime < 3.0f) {
+            DrawText(traceMessage.c_str(), BOARD_OFFSET_X, SCREEN_HEIGHT - 30, 20, YELLOW);
+        }
+        
+        // Frame work, without the wait for vsync or input below
+        int64_t frameEnd = profileNowUs(profiler);
+        profileRecord(profiler, "frame", frameStart, frameEnd);
+        profileFrame(profiler, (frameEnd - frameStart) / 1000.0f);
+        {
+            ProfileScope scope(profiler, "EndDrawing");
+            EndDrawing();
+        }
+        
+        // Sleep until the next input event while nothing is moving on screen
+        bool reviewBusy = gameReview.completed < gameReview.count;
+        bool idle = !isAnimating && !analysisBusy && !reviewBusy && (gameOver || currentPlayer == PLAYER_BLACK);
+        if (idle != waitingForEvents) {
+            if (idle) EnableEventWaiting();
+            else DisableEventWaiting();
+            waitingForEvents = idle;
+        }
     }
     
+    stopAIMove();
+    stopAnalysis();
+    reviewStop(gameReview);
+    UnloadRenderTexture(boardTexture);
+    cacheClose(searchCache);
     CloseWindow();
     return 0;
 }
@@ -0,0 +1,275 @@
+#ifndef REVERSI_SEARCH_H
+#define REVERSI_SEARCH_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include "Bitboard.h"
+#include "CpuDispatch.h"
+#include "NNUE.h"
+#include "Symmetry.h"
+
+// Reentrant bitboard alpha-beta search used for analysis.
+//
+// Scores follow the game files' minimax: the evaluation is always taken from
+// the root player's point of view (the edge term only counts the root
+// player's edges) and negated when the other side is to move. A pass costs
+// one ply, and the search stops when the board is full.
+// Any number of threads may share one TranspositionTable; each thread needs
+// its own SearchContext.
+
+const int SEARCH_INFINITY = 100000;
+const int CORNER_WEIGHT = 25;
+const uint64_t BB_CORNERS = 0x8100000000000081ULL;
+const uint64_t BB_FULL = ~0ULL;
+
+const uint8_t TT_EXACT = 0;
+const uint8_t TT_LOWER = 1;
+const uint8_t TT_UPPER = 2;
+const uint64_t TT_SIDE_KEY = 0xD1B54A32D192ED03ULL;
+
+// Edge squares sharing index i: (0, i), (7, i), (i, 0), (i, 7)
+inline uint64_t edgeLine(int i) {
+    return squareBit(i) | squareBit(56 + i) | squareBit(8 * i) | squareBit(8 * i + 7);
+}
+
+// evaluateBoard on bitboards, from the point of view of the side owning me
+inline int evaluatePosition(uint64_t me, uint64_t opp, int edgeWeight) {
+    int score = engineKernels.discCount(me) - engineKernels.discCount(opp);
+    score += CORNER_WEIGHT * (engineKernels.discCount(me & BB_CORNERS) - engineKernels.discCount(opp & BB_CORNERS));
+    if (edgeWeight) {
+        for (int i = 0; i < BB_SIZE; i++) {
+            if (me & edgeLine(i)) score += edgeWeight;
+        }
+    }
+    return score;
+}
+
+// ---- Transposition table ----
+// Lock-free: each slot stores key ^ data next to data, so a torn write
+// from another thread simply reads as a miss.
+
+struct TTSlot {
+    std::atomic<uint64_t> check;
+    std::atomic<uint64_t> data;
+};
+
+struct TranspositionTable {
+    std::unique_ptr<TTSlot[]> slots;
+    uint64_t mask = 0;
+};
+
+struct TTEntry {
+    int score;
+    int depth;
+    uint8_t bound;
+    int bestMove;
+};
+
+inline void ttInit(TranspositionTable &tt, int sizeLog2 = 20) {
+    uint64_t size = 1ULL << sizeLog2;
+    tt.slots.reset(new TTSlot[size]);
+    tt.mask = size - 1;
+    for (uint64_t i = 0; i < size; i++) {
+        tt.slots[i].check.store(0, std::memory_order_relaxed);
+        tt.slots[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+inline void ttClear(TranspositionTable &tt) {
+    for (uint64_t i = 0; i <= tt.mask && tt.slots; i++) {
+        tt.slots[i].check.store(0, std::memory_order_relaxed);
+        tt.slots[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+inline bool ttProbe(const TranspositionTable &tt, uint64_t key, TTEntry &entry) {
+    if (!tt.slots) return false;
+    const TTSlot &slot = tt.slots[key & tt.mask];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    if ((slot.check.load(std::memory_order_relaxed) ^ data) != key || data == 0) return false;
+    entry.score = (int16_t)(data & 0xFFFF);
+    entry.depth = (int)((data >> 16) & 0xFF);
+    entry.bound = (uint8_t)((data >> 24) & 0xFF);
+    entry.bestMove = (int)((data >> 32) & 0xFF);
+    return true;
+}
+
+inline void ttStore(TranspositionTable &tt, uint64_t key, int depth, uint8_t bound, int score, int bestMove) {
+    if (!tt.slots) return;
+    TTSlot &slot = tt.slots[key & tt.mask];
+    uint64_t old = slot.data.load(std::memory_order_relaxed);
+    bool sameKey = (slot.check.load(std::memory_order_relaxed) ^ old) == key;
+    if (sameKey && (int)((old >> 16) & 0xFF) > depth) return;
+
+    uint64_t data = (uint64_t)(uint16_t)score | ((uint64_t)depth << 16) | ((uint64_t)bound << 24)
+                  | ((uint64_t)(uint8_t)(bestMove < 0 ? BB_PASS : bestMove) << 32) | (1ULL << 40);
+    slot.data.store(data, std::memory_order_relaxed);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+}
+
+// ---- Search ----
+
+struct SearchContext {
+    TranspositionTable *tt = nullptr;
+    int edgeWeight = 0;
+    const NNUENetwork *net = nullptr;                   // evaluate with this network instead, like minimax
+    uint64_t nodes = 0;
+    const std::atomic<bool> *stop = nullptr;
+    uint64_t nodeLimit = 0;                             // 0 = none
+    std::chrono::steady_clock::time_point deadline{};   // epoch = none
+    bool stopped = false;                               // latched once any limit is hit
+};
+
+inline bool searchStopped(const SearchContext &ctx) {
+    if (ctx.stopped) return true;
+    if (ctx.stop && ctx.stop->load(std::memory_order_relaxed)) return true;
+    if (ctx.nodeLimit && ctx.nodes >= ctx.nodeLimit) return true;
+    return ctx.deadline != std::chrono::steady_clock::time_point() && std::chrono::steady_clock::now() >= ctx.deadline;
+}
+
+inline int evaluateForSide(const SearchContext &ctx, uint64_t P, uint64_t O, bool rootToMove) {
+    if (ctx.net) return rootToMove ? nnueEvaluateBoards(*ctx.net, P, O) : -nnueEvaluateBoards(*ctx.net, O, P);
+    return rootToMove ? evaluatePosition(P, O, ctx.edgeWeight) : -evaluatePosition(O, P, ctx.edgeWeight);
+}
+
+// Negamax score of (P, O) for the side to move. Returns garbage once stopped.
+inline int searchNegamax(SearchContext &ctx, uint64_t P, uint64_t O, int depth, int alpha, int beta, bool rootToMove) {
+    ctx.nodes++;
+    if (depth == 0 || (P | O) == BB_FULL) {
+        return evaluateForSide(ctx, P, O, rootToMove);
+    }
+    if (ctx.stopped) return 0;
+    if ((ctx.nodes & 1023) == 0 && searchStopped(ctx)) {
+        ctx.stopped = true;
+        return 0;
+    }
+
+    uint64_t moves = engineKernels.moves(P, O);
+    if (moves == 0) {
+        if (engineKernels.moves(O, P) == 0) return evaluateForSide(ctx, P, O, rootToMove);
+        return -searchNegamax(ctx, O, P, depth - 1, -beta, -alpha, !rootToMove);
+    }
+
+    uint64_t key = hashPosition(P, O) ^ (rootToMove ? 0 : TT_SIDE_KEY);
+    int ttMove = -1;
+    TTEntry entry;
+    if (ctx.tt && ttProbe(*ctx.tt, key, entry)) {
+        if (entry.bestMove != BB_PASS && (moves & squareBit(entry.bestMove))) ttMove = entry.bestMove;
+        if (entry.depth >= depth) {
+            if (entry.bound == TT_EXACT) return entry.score;
+            if (entry.bound == TT_LOWER && entry.score > alpha) alpha = entry.score;
+            if (entry.bound == TT_UPPER && entry.score < beta) beta = entry.score;
+            if (alpha >= beta) return entry.score;
+        }
+    }
+
+    int alphaOrig = alpha;
+    int best = -SEARCH_INFINITY;
+    int bestMove = -1;
+    uint64_t remaining = moves;
+    while (remaining) {
+        int sq;
+        if (ttMove >= 0) {
+            sq = ttMove;
+            ttMove = -1;
+        } else {
+            sq = firstSquare(remaining);
+        }
+        remaining &= ~squareBit(sq);
+
+        uint64_t flips = engineKernels.flips(sq, P, O);
+        int score = -searchNegamax(ctx, O & ~flips, P | flips | squareBit(sq), depth - 1, -beta, -alpha, !rootToMove);
+        if (score > best) {
+            best = score;
+            bestMove = sq;
+            if (best > alpha) alpha = best;
+            if (alpha >= beta) break;
+        }
+    }
+
+    if (ctx.tt && !searchStopped(ctx)) {
+        uint8_t bound = best <= alphaOrig ? TT_UPPER : (best >= beta ? TT_LOWER : TT_EXACT);
+        ttStore(*ctx.tt, key, depth, bound, best, bestMove);
+    }
+    return best;
+}
+
+// ---- Multi-PV root analysis ----
+
+struct MoveScore {
+    int move;
+    int score;
+    bool exact;     // false: score is only an upper bound (the move is outside the top N)
+};
+
+// Scores every legal move of (P, O) at the given depth. The top multiPV
+// scores are exact (multiPV <= 0 makes all of them exact); the rest are
+// upper bounds. Results are sorted best first; returns the number of moves.
+inline int analyseRootMoves(SearchContext &ctx, uint64_t P, uint64_t O, int depth, int multiPV, MoveScore out[BB_SQUARES]) {
+    uint64_t moves = engineKernels.moves(P, O);
+    int count = 0;
+
+    // Previous best first, so the window tightens early
+    TTEntry entry;
+    uint64_t key = hashPosition(P, O);
+    int first = -1;
+    if (ctx.tt && ttProbe(*ctx.tt, key, entry) && entry.bestMove != BB_PASS && (moves & squareBit(entry.bestMove))) {
+        first = entry.bestMove;
+    }
+
+    int bestMove = -1;
+    int bestScore = -SEARCH_INFINITY;
+    while (moves) {
+        int sq = first >= 0 ? first : firstSquare(moves);
+        first = -1;
+        moves &= ~squareBit(sq);
+
+        // N-th best exact score so far: a move has to beat it to enter the top N
+        int alpha = -SEARCH_INFINITY;
+        if (multiPV > 0) {
+            int exact[BB_SQUARES];
+            int exactCount = 0;
+            for (int i = 0; i < count; i++) {
+                if (out[i].exact) exact[exactCount++] = out[i].score;
+            }
+            if (exactCount >= multiPV) {
+                std::nth_element(exact, exact + multiPV - 1, exact + exactCount, std::greater<int>());
+                alpha = exact[multiPV - 1];
+            }
+        }
+
+        uint64_t flips = engineKernels.flips(sq, P, O);
+        int score = -searchNegamax(ctx, O & ~flips, P | flips | squareBit(sq), depth - 1, -SEARCH_INFINITY, -alpha, false);
+        if (searchStopped(ctx)) return 0;
+
+        out[count].move = sq;
+        out[count].score = score;
+        out[count].exact = score > alpha || alpha == -SEARCH_INFINITY;
+        count++;
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = sq;
+        }
+    }
+
+    // Insertion sort, best first
+    for (int i = 1; i < count; i++) {
+        MoveScore item = out[i];
+        int j = i - 1;
+        while (j >= 0 && (out[j].score < item.score || (out[j].score == item.score && !out[j].exact && item.exact))) {
+            out[j + 1] = out[j];
+            j--;
+        }
+        out[j + 1] = item;
+    }
+
+    if (ctx.tt && bestMove >= 0) ttStore(*ctx.tt, key, depth, TT_EXACT, bestScore, bestMove);
+    return count;
+}
+
+#endif
@@ -0,0 +1,269 @@
+#ifndef REVERSI_SEARCH_CACHE_H
+#define REVERSI_SEARCH_CACHE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "Bitboard.h"
+#include "Symmetry.h"
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/file.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// Persistent search cache shared between runs and processes.
+//
+// The file is a fixed-size hash table of 4-entry buckets, mapped read-only
+// at startup. Results found during a session are kept in memory and merged
+// into the file under an exclusive lock by cacheClose. When a bucket is full
+// the entry with the lowest depth (aged by generation) is evicted, so the
+// file never grows past the size it was created with.
+// Positions are stored in canonical form (see Symmetry.h).
+// Readers take no lock, so every entry carries a checksum: an entry that
+// another process is rewriting is copied out and only used if it checks out.
+
+const uint32_t CACHE_VERSION = 1;
+const uint32_t CACHE_DEFAULT_SLOTS = 1 << 18;
+const int CACHE_BUCKET = 4;
+const int CACHE_HEADER_BYTES = 64;
+
+const uint8_t CACHE_EXACT = 0;
+const uint8_t CACHE_LOWER = 1;
+const uint8_t CACHE_UPPER = 2;
+const uint8_t CACHE_DEPTH_SOLVED = 64;
+
+struct CacheEntry {
+    uint64_t P;
+    uint64_t O;
+    int16_t score;
+    uint8_t depth;      // 0 = empty slot, CACHE_DEPTH_SOLVED = exact endgame result
+    uint8_t bound;
+    uint8_t bestMove;   // BB_PASS if none
+    uint8_t generation;
+    uint16_t check;     // cacheEntryCheck of the other fields
+};
+
+struct SearchCache {
+    uint8_t *map = nullptr;
+    size_t mapSize = 0;
+    uint32_t slotCount = 0;
+    uint32_t evalId = 0;
+    uint8_t generation = 0;
+    std::string path;
+    std::mutex lock;
+    std::unordered_map<uint64_t, CacheEntry> pending;
+};
+
+inline uint16_t cacheEntryCheck(const CacheEntry &e) {
+    uint64_t h = e.P;
+    h = (h ^ (h >> 33)) * 0xFF51AFD7ED558CCDULL ^ e.O;
+    h = (h ^ (h >> 33)) * 0xC4CEB9FE1A85EC53ULL ^ ((uint64_t)(uint16_t)e.score | (uint64_t)e.depth << 16
+        | (uint64_t)e.bound << 24 | (uint64_t)e.bestMove << 32 | (uint64_t)e.generation << 40);
+    h = (h ^ (h >> 33)) * 0xFF51AFD7ED558CCDULL;
+    return (uint16_t)(h >> 48);
+}
+
+// Entries from before the checksum, or torn by a concurrent write, read as empty
+inline bool cacheEntryValid(const CacheEntry &e) {
+    return e.depth != 0 && e.check == cacheEntryCheck(e);
+}
+
+inline CacheEntry *cacheSlots(uint8_t *map) {
+    return (CacheEntry *)(map + CACHE_HEADER_BYTES);
+}
+
+// Maps the cache file, creating it with slotCount entries if it does not exist.
+// Fails for a file written for a different evaluation function.
+inline bool cacheOpenFile(SearchCache &cache, const std::string &path, uint32_t evalId, uint32_t slotCount) {
+    cache.path = path;
+    cache.evalId = evalId;
+    #ifdef _WIN32
+        (void)slotCount;
+        return false;
+    #else
+        int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) return false;
+
+        flock(fd, LOCK_EX);
+        struct stat st;
+        fstat(fd, &st);
+        if (st.st_size == 0) {
+            uint8_t header[CACHE_HEADER_BYTES] = {0};
+            memcpy(header, "RVSC", 4);
+            memcpy(header + 4, &CACHE_VERSION, 4);
+            memcpy(header + 8, &evalId, 4);
+            memcpy(header + 12, &slotCount, 4);
+            size_t size = CACHE_HEADER_BYTES + (size_t)slotCount * sizeof(CacheEntry);
+            if (pwrite(fd, header, sizeof(header), 0) != (ssize_t)sizeof(header) || ftruncate(fd, size) != 0) {
+                flock(fd, LOCK_UN);
+                close(fd);
+                return false;
+            }
+            st.st_size = size;
+        }
+        flock(fd, LOCK_UN);
+
+        void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) return false;
+
+        uint8_t *map = (uint8_t *)p;
+        uint32_t version, fileEvalId, fileSlots;
+        memcpy(&version, map + 4, 4);
+        memcpy(&fileEvalId, map + 8, 4);
+        memcpy(&fileSlots, map + 12, 4);
+        bool valid = memcmp(map, "RVSC", 4) == 0 && version == CACHE_VERSION && fileEvalId == evalId
+                  && fileSlots >= CACHE_BUCKET && (fileSlots & (fileSlots - 1)) == 0
+                  && (size_t)st.st_size == CACHE_HEADER_BYTES + (size_t)fileSlots * sizeof(CacheEntry);
+        if (!valid) {
+            munmap(p, st.st_size);
+            return false;
+        }
+
+        cache.map = map;
+        cache.mapSize = st.st_size;
+        cache.slotCount = fileSlots;
+        cache.generation = map[16];
+        return true;
+    #endif
+}
+
+// Opens path, or path.<evalId> when path belongs to another evaluation
+// function (or cache version), so each evaluation keeps its own file.
+// cache.path is the file actually used.
+inline bool cacheOpen(SearchCache &cache, const std::string &path, uint32_t evalId, uint32_t slotCount = CACHE_DEFAULT_SLOTS) {
+    if (cacheOpenFile(cache, path, evalId, slotCount)) return true;
+    char suffix[16];
+    snprintf(suffix, sizeof(suffix), ".%08x", evalId);
+    return cacheOpenFile(cache, path + suffix, evalId, slotCount);
+}
+
+inline uint32_t cacheBucket(const SearchCache &cache, uint64_t key) {
+    return (uint32_t)(key & (cache.slotCount - 1)) & ~(uint32_t)(CACHE_BUCKET - 1);
+}
+
+// Looks up a position; the returned best move is in the caller's orientation
+inline bool cacheProbe(SearchCache &cache, uint64_t P, uint64_t O, CacheEntry &result) {
+    if (!cache.map) return false;
+    uint64_t cp, co;
+    int t = canonicalPosition(P, O, cp, co);
+    uint64_t key = hashPosition(cp, co);
+    bool found = false;
+
+    {
+        std::lock_guard<std::mutex> guard(cache.lock);
+        auto it = cache.pending.find(key);
+        if (it != cache.pending.end() && it->second.P == cp && it->second.O == co) {
+            result = it->second;
+            found = true;
+        }
+    }
+    if (!found) {
+        const CacheEntry *bucket = cacheSlots(cache.map) + cacheBucket(cache, key);
+        for (int i = 0; i < CACHE_BUCKET; i++) {
+            CacheEntry e;
+            memcpy(&e, &bucket[i], sizeof(e));
+            if (cacheEntryValid(e) && e.P == cp && e.O == co) {
+                result = e;
+                found = true;
+                break;
+            }
+        }
+    }
+    if (found) {
+        result.P = P;
+        result.O = O;
+        if (result.bestMove != BB_PASS) result.bestMove = (uint8_t)inverseTransformSquare(result.bestMove, t);
+    }
+    return found;
+}
+
+inline void cacheStore(SearchCache &cache, uint64_t P, uint64_t O, int depth, uint8_t bound, int score, int bestMove) {
+    if (!cache.map || depth <= 0) return;
+    CacheEntry entry;
+    int t = canonicalPosition(P, O, entry.P, entry.O);
+    entry.score = (int16_t)score;
+    entry.depth = (uint8_t)(depth < CACHE_DEPTH_SOLVED ? depth : CACHE_DEPTH_SOLVED);
+    entry.bound = bound;
+    entry.bestMove = (uint8_t)(bestMove >= 0 && bestMove < BB_SQUARES ? transformSquare(bestMove, t) : BB_PASS);
+    entry.generation = cache.generation;
+    entry.check = 0;    // set when merged into the file
+
+    std::lock_guard<std::mutex> guard(cache.lock);
+    CacheEntry &slot = cache.pending[hashPosition(entry.P, entry.O)];
+    if (slot.depth <= entry.depth) slot = entry;
+}
+
+// Replacement priority: deeper and more recent entries are worth keeping
+inline int cacheWorth(const CacheEntry &e, uint8_t generation) {
+    if (!cacheEntryValid(e)) return -1000;
+    int age = (uint8_t)(generation - e.generation);
+    return e.depth * 4 + (e.bound == CACHE_EXACT ? 2 : 0) - age;
+}
+
+// Merges this session's results into the file and unmaps it
+inline bool cacheClose(SearchCache &cache) {
+    if (!cache.map) return false;
+    bool ok = true;
+
+    #ifndef _WIN32
+    {
+        std::lock_guard<std::mutex> guard(cache.lock);
+        int fd = cache.pending.empty() ? -1 : open(cache.path.c_str(), O_RDWR);
+        if (fd >= 0) {
+            flock(fd, LOCK_EX);
+            void *p = mmap(nullptr, cache.mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED) {
+                uint8_t *map = (uint8_t *)p;
+                uint8_t generation = (uint8_t)(map[16] + 1);
+                map[16] = generation;
+                CacheEntry *slots = cacheSlots(map);
+
+                for (auto &item : cache.pending) {
+                    CacheEntry e = item.second;
+                    e.generation = generation;
+                    e.check = cacheEntryCheck(e);
+                    CacheEntry *bucket = slots + cacheBucket(cache, item.first);
+                    int victim = 0;
+                    for (int i = 0; i < CACHE_BUCKET; i++) {
+                        if (cacheEntryValid(bucket[i]) && bucket[i].P == e.P && bucket[i].O == e.O) {
+                            victim = i;
+                            break;
+                        }
+                        if (cacheWorth(bucket[i], generation) < cacheWorth(bucket[victim], generation)) {
+                            victim = i;
+                        }
+                    }
+                    CacheEntry &slot = bucket[victim];
+                    bool samePosition = cacheEntryValid(slot) && slot.P == e.P && slot.O == e.O;
+                    if (!samePosition || slot.depth <= e.depth) {
+                        slot = e;
+                    } else {
+                        slot.generation = generation;
+                        slot.check = cacheEntryCheck(slot);
+                    }
+                }
+                ok = msync(p, cache.mapSize, MS_SYNC) == 0;
+                munmap(p, cache.mapSize);
+            } else {
+                ok = false;
+            }
+            flock(fd, LOCK_UN);
+            close(fd);
+        }
+        cache.pending.clear();
+        munmap(cache.map, cache.mapSize);
+    }
+    #endif
+    cache.map = nullptr;
+    cache.mapSize = 0;
+    return ok;
+}
+
+#endif
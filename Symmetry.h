@@ -0,0 +1,130 @@
+#ifndef REVERSI_SYMMETRY_H
+#define REVERSI_SYMMETRY_H
+
+#include <cstdint>
+#include "Bitboard.h"
+
+// The 8 board symmetries. A transform index t applies, in order:
+// transpose if (t & 4), vertical flip if (t & 2), horizontal mirror if (t & 1).
+// Caches, books and analysis tables key positions by canonicalPosition so all
+// symmetric variants share one entry.
+
+const int SYMMETRY_COUNT = 8;
+
+// Reverses the row order (row r -> row 7 - r)
+inline uint64_t flipVertical(uint64_t b) {
+    return __builtin_bswap64(b);
+}
+
+// Reverses the column order (col c -> col 7 - c)
+inline uint64_t mirrorHorizontal(uint64_t b) {
+    const uint64_t k1 = 0x5555555555555555ULL;
+    const uint64_t k2 = 0x3333333333333333ULL;
+    const uint64_t k4 = 0x0F0F0F0F0F0F0F0FULL;
+    b = ((b >> 1) & k1) | ((b & k1) << 1);
+    b = ((b >> 2) & k2) | ((b & k2) << 2);
+    b = ((b >> 4) & k4) | ((b & k4) << 4);
+    return b;
+}
+
+// Swaps rows and columns (row r, col c -> row c, col r)
+inline uint64_t transposeBoard(uint64_t b) {
+    const uint64_t k1 = 0x5500550055005500ULL;
+    const uint64_t k2 = 0x3333000033330000ULL;
+    const uint64_t k4 = 0x0F0F0F0F00000000ULL;
+    uint64_t t;
+    t = k4 & (b ^ (b << 28));
+    b ^= t ^ (t >> 28);
+    t = k2 & (b ^ (b << 14));
+    b ^= t ^ (t >> 14);
+    t = k1 & (b ^ (b << 7));
+    b ^= t ^ (t >> 7);
+    return b;
+}
+
+inline uint64_t transformBitboard(uint64_t b, int t) {
+    if (t & 4) b = transposeBoard(b);
+    if (t & 2) b = flipVertical(b);
+    if (t & 1) b = mirrorHorizontal(b);
+    return b;
+}
+
+inline uint64_t inverseTransformBitboard(uint64_t b, int t) {
+    if (t & 1) b = mirrorHorizontal(b);
+    if (t & 2) b = flipVertical(b);
+    if (t & 4) b = transposeBoard(b);
+    return b;
+}
+
+inline int transformSquare(int sq, int t) {
+    int row = sq / BB_SIZE;
+    int col = sq % BB_SIZE;
+    if (t & 4) {
+        int tmp = row;
+        row = col;
+        col = tmp;
+    }
+    if (t & 2) row = BB_SIZE - 1 - row;
+    if (t & 1) col = BB_SIZE - 1 - col;
+    return row * BB_SIZE + col;
+}
+
+// Maps a square of the canonical board back onto the original board
+inline int inverseTransformSquare(int sq, int t) {
+    if (sq < 0 || sq >= BB_SQUARES) return sq;
+    int row = sq / BB_SIZE;
+    int col = sq % BB_SIZE;
+    if (t & 1) col = BB_SIZE - 1 - col;
+    if (t & 2) row = BB_SIZE - 1 - row;
+    if (t & 4) {
+        int tmp = row;
+        row = col;
+        col = tmp;
+    }
+    return row * BB_SIZE + col;
+}
+
+// Smallest (P, O) over all 8 symmetries; returns the transform that produced it
+inline int canonicalPosition(uint64_t P, uint64_t O, uint64_t &canonP, uint64_t &canonO) {
+    uint64_t p[SYMMETRY_COUNT];
+    uint64_t o[SYMMETRY_COUNT];
+    p[0] = P;
+    o[0] = O;
+    p[4] = transposeBoard(P);
+    o[4] = transposeBoard(O);
+    for (int base = 0; base < SYMMETRY_COUNT; base += 4) {
+        p[base + 1] = mirrorHorizontal(p[base]);
+        o[base + 1] = mirrorHorizontal(o[base]);
+        p[base + 2] = flipVertical(p[base]);
+        o[base + 2] = flipVertical(o[base]);
+        p[base + 3] = flipVertical(p[base + 1]);
+        o[base + 3] = flipVertical(o[base + 1]);
+    }
+
+    int best = 0;
+    for (int t = 1; t < SYMMETRY_COUNT; t++) {
+        if (p[t] < p[best] || (p[t] == p[best] && o[t] < o[best])) {
+            best = t;
+        }
+    }
+    canonP = p[best];
+    canonO = o[best];
+    return best;
+}
+
+// 64-bit hash of a (canonical) position
+inline uint64_t hashPosition(uint64_t P, uint64_t O) {
+    uint64_t h = P * 0x9E3779B97F4A7C15ULL ^ (O + 0x632BE59BD9B4E019ULL) * 0xC2B2AE3D27D4EB4FULL;
+    h ^= h >> 31;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 29;
+    return h;
+}
+
+inline uint64_t canonicalKey(uint64_t P, uint64_t O) {
+    uint64_t cp, co;
+    canonicalPosition(P, O, cp, co);
+    return hashPosition(cp, co);
+}
+
+#endif